@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    CoefficientSnapshot.h
+    Hands the coefficients the audio thread is running to one reader
+    (the editor) without locks: a triple buffer, so a writer never waits
+    and the reader always gets a complete, consistent set. The message
+    thread writes too, while the host is stopped; the two take turns and
+    the one that finds the other mid publish skips its own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "EQDesign.h"
+
+#include <atomic>
+#include <cstdint>
+
+struct CoefficientSnapshot {
+    ChainCoefficients coefficients[numParameterSets]; //the second only means something when stereoMode uses it
+    StereoMode stereoMode{ Stereo_Linked };
+    double sampleRate{ 0 };
+    uint32_t version{ 0 }; //0 until the first publish
+};
+
+class CoefficientSnapshotPublisher
+{
+public:
+    //writer side, audio or message thread; returns false, having published nothing,
+    //if the other writer was publishing
+    bool publish(const ChainCoefficients& first, const ChainCoefficients& second, StereoMode stereoMode, double sampleRate) {
+        if (writing.exchange(true, std::memory_order_acquire))
+            return false;
+
+        auto& back = buffers[backIndex];
+        back.coefficients[0] = first;
+        back.coefficients[1] = second;
+        back.stereoMode = stereoMode;
+        back.sampleRate = sampleRate;
+        back.version = ++lastVersion;
+
+        backIndex = middle.exchange(uint8_t(backIndex | dirtyBit), std::memory_order_acq_rel) & indexMask;
+
+        writing.store(false, std::memory_order_release);
+        return true;
+    }
+
+    //reader side, message thread; the reference stays valid until the next call
+    const CoefficientSnapshot& acquire() {
+        if (middle.load(std::memory_order_relaxed) & dirtyBit)
+            frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+
+        return buffers[frontIndex];
+    }
+
+private:
+    static constexpr uint8_t indexMask = 3, dirtyBit = 4;
+
+    CoefficientSnapshot buffers[3];
+    uint8_t backIndex{ 0 }, frontIndex{ 1 };
+    std::atomic<uint8_t> middle{ 2 };
+    uint32_t lastVersion{ 0 }; //with backIndex, owned by whichever writer holds the turn
+    std::atomic<bool> writing{ false };
+};
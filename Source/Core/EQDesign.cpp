@@ -0,0 +1,288 @@
+/*
+  ==============================================================================
+
+    EQDesign.cpp
+    Same formulas as juce::dsp::IIR::Coefficients / FilterDesign, so the
+    core library and the plugin produce the same response.
+
+  ==============================================================================
+*/
+
+#include "EQDesign.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace {
+
+constexpr double pi = 3.141592653589793238;
+
+//keep the design away from 0 Hz and nyquist where tan() blows up
+double limitFrequency(double frequency, double sampleRate) {
+    return std::clamp(frequency, 2.0, sampleRate * 0.499);
+}
+
+BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2) {
+    auto a0inv = 1.0 / a0;
+    return { float(b0 * a0inv), float(b1 * a0inv), float(b2 * a0inv), float(a1 * a0inv), float(a2 * a0inv) };
+}
+
+BiquadCoefficients makeLowPass(double sampleRate, double frequency, double Q) {
+    auto n = 1.0 / std::tan(pi * frequency / sampleRate);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / Q;
+    auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return normalise(c1, c1 * 2.0, c1,
+                     1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+}
+
+BiquadCoefficients makeHighPass(double sampleRate, double frequency, double Q) {
+    auto n = std::tan(pi * frequency / sampleRate);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / Q;
+    auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return normalise(c1, c1 * -2.0, c1,
+                     1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+}
+
+//Q of the i'th biquad of an even order butterworth
+double butterworthQ(int i, int order) {
+    return 1.0 / (2.0 * std::cos((2.0 * i + 1.0) * pi / (order * 2.0)));
+}
+
+int getCutOrder(Slope slope) {
+    return (slope + 1) * 2;
+}
+
+}
+
+double BiquadCoefficients::getMagnitudeForFrequency(double frequency, double sampleRate) const {
+    auto w = 2.0 * pi * frequency / sampleRate;
+    auto z1 = std::polar(1.0, -w);
+    auto z2 = z1 * z1;
+
+    auto numerator = double(b0) + double(b1) * z1 + double(b2) * z2;
+    auto denominator = 1.0 + double(a1) * z1 + double(a2) * z2;
+
+    return std::abs(numerator / denominator);
+}
+
+double ChainCoefficients::getMagnitudeForFrequency(double frequency, double sampleRate) const {
+    double mag = 1.0;
+
+    for (int i = 0; i < numChainSections; ++i) {
+        if (isActive(i))
+            mag *= sections[i].getMagnitudeForFrequency(frequency, sampleRate);
+    }
+
+    return mag;
+}
+
+BiquadCoefficients designPeakFilter(const ChainSettings& chainSettings, double sampleRate) {
+    auto frequency = limitFrequency(chainSettings.peakFreq, sampleRate);
+    auto gainFactor = std::pow(10.0, chainSettings.peakGainInDecibels / 20.0);
+
+    auto A = std::sqrt(std::max(gainFactor, 0.0));
+    auto omega = (2.0 * pi * frequency) / sampleRate;
+    auto coso = std::cos(omega);
+    auto alpha = std::sin(omega) / (chainSettings.peakQuality * 2.0);
+    auto alphaTimesA = alpha * A;
+    auto alphaOverA = alpha / A;
+
+    return normalise(1.0 + alphaTimesA, -2.0 * coso, 1.0 - alphaTimesA,
+                     1.0 + alphaOverA, -2.0 * coso, 1.0 - alphaOverA);
+}
+
+DynamicPeakDesign designDynamicPeak(const ChainSettings& chainSettings, double sampleRate) {
+    DynamicPeakDesign design;
+
+    auto frequency = limitFrequency(chainSettings.peakFreq, sampleRate);
+    auto omega = (2.0 * pi * frequency) / sampleRate;
+    auto alpha = std::sin(omega) / (chainSettings.peakQuality * 2.0);
+
+    design.cosOmega = float(std::cos(omega));
+    design.alpha = float(alpha);
+
+    design.staticGainInDecibels = chainSettings.peakGainInDecibels;
+    design.threshold = chainSettings.peakThreshold;
+    design.slope = 1.f - 1.f / std::max(chainSettings.peakRatio, 1.f);
+
+    auto timeToCoefficient = [sampleRate](double ms) {
+        return float(std::exp(-1.0 / (std::max(ms, 0.01) * 0.001 * sampleRate)));
+    };
+    design.attackCoefficient = timeToCoefficient(chainSettings.peakAttack);
+    design.releaseCoefficient = timeToCoefficient(chainSettings.peakRelease);
+
+    design.detector = normalise(alpha, 0.0, -alpha,
+                                1.0 + alpha, -2.0 * design.cosOmega, 1.0 - alpha);
+
+    return design;
+}
+
+BiquadCoefficients makeDynamicPeak(const DynamicPeakDesign& design, float gainInDecibels) {
+    //A = sqrt(gainFactor) = 10^(dB / 40)
+    auto A = std::exp(gainInDecibels * 0.05756462732485115f);
+    auto alphaTimesA = design.alpha * A;
+    auto alphaOverA = design.alpha / A;
+    auto a0inv = 1.f / (1.f + alphaOverA);
+    auto b1 = -2.f * design.cosOmega * a0inv;
+
+    return { (1.f + alphaTimesA) * a0inv, b1, (1.f - alphaTimesA) * a0inv, b1, (1.f - alphaOverA) * a0inv };
+}
+
+int designLowCutFilter(const ChainSettings& chainSettings, double sampleRate, BiquadCoefficients* sections) {
+    auto frequency = limitFrequency(chainSettings.lowCutFreq, sampleRate);
+    auto order = getCutOrder(chainSettings.lowCutSlope);
+
+    for (int i = 0; i < order / 2; ++i)
+        sections[i] = makeHighPass(sampleRate, frequency, butterworthQ(i, order));
+
+    return order / 2;
+}
+
+int designHighCutFilter(const ChainSettings& chainSettings, double sampleRate, BiquadCoefficients* sections) {
+    auto frequency = limitFrequency(chainSettings.highCutFreq, sampleRate);
+    auto order = getCutOrder(chainSettings.highCutSlope);
+
+    for (int i = 0; i < order / 2; ++i)
+        sections[i] = makeLowPass(sampleRate, frequency, butterworthQ(i, order));
+
+    return order / 2;
+}
+
+void designChain(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chain) {
+    chain.activeSections = 0;
+
+    auto numLowCut = designLowCutFilter(chainSettings, sampleRate, chain.sections + getSectionIndex(LowCut));
+    for (int i = 0; i < numLowCut; ++i)
+        chain.activeSections |= 1u << getSectionIndex(LowCut, i);
+
+    chain.sections[getSectionIndex(Peak)] = designPeakFilter(chainSettings, sampleRate);
+    chain.activeSections |= 1u << getSectionIndex(Peak);
+
+    auto numHighCut = designHighCutFilter(chainSettings, sampleRate, chain.sections + getSectionIndex(HighCut));
+    for (int i = 0; i < numHighCut; ++i)
+        chain.activeSections |= 1u << getSectionIndex(HighCut, i);
+}
+
+void designChain(const ChainSettings& chainSettings, double sampleRate, ChainDesign& design) {
+    design.settings = chainSettings;
+    design.sampleRate = sampleRate;
+    designChain(chainSettings, sampleRate, design.coefficients);
+    design.dynamicPeak = designDynamicPeak(chainSettings, sampleRate);
+}
+
+ChainSettings interpolateSettings(const ChainSettings& a, const ChainSettings& b, float amount) {
+    amount = std::clamp(amount, 0.f, 1.f);
+
+    auto linear = [amount](float from, float to) { return from + (to - from) * amount; };
+    auto geometric = [amount](float from, float to) { return from * std::pow(to / from, amount); };
+
+    auto settings = amount < 0.5f ? a : b;
+
+    settings.peakFreq = geometric(a.peakFreq, b.peakFreq);
+    settings.peakGainInDecibels = linear(a.peakGainInDecibels, b.peakGainInDecibels);
+    settings.peakQuality = geometric(a.peakQuality, b.peakQuality);
+    settings.lowCutFreq = geometric(a.lowCutFreq, b.lowCutFreq);
+    settings.highCutFreq = geometric(a.highCutFreq, b.highCutFreq);
+
+    settings.peakThreshold = linear(a.peakThreshold, b.peakThreshold);
+    settings.peakRatio = geometric(a.peakRatio, b.peakRatio);
+    settings.peakAttack = geometric(a.peakAttack, b.peakAttack);
+    settings.peakRelease = geometric(a.peakRelease, b.peakRelease);
+
+    return settings;
+}
+
+//BS.1770 stage 1
+BiquadCoefficients designKWeightingShelf(double sampleRate) {
+    const double f0 = 1681.974450955533, G = 3.999843853973347, Q = 0.7071752369554196;
+
+    auto K = std::tan(pi * f0 / sampleRate);
+    auto Vh = std::pow(10.0, G / 20.0);
+    auto Vb = std::pow(Vh, 0.4996667741545416);
+    auto a0 = 1.0 + K / Q + K * K;
+
+    return { float((Vh + Vb * K / Q + K * K) / a0), float(2.0 * (K * K - Vh) / a0), float((Vh - Vb * K / Q + K * K) / a0),
+             float(2.0 * (K * K - 1.0) / a0), float((1.0 - K / Q + K * K) / a0) };
+}
+
+//BS.1770 stage 2
+BiquadCoefficients designKWeightingHighPass(double sampleRate) {
+    const double f0 = 38.13547087602444, Q = 0.5003270373238773;
+
+    auto K = std::tan(pi * f0 / sampleRate);
+    auto a0 = 1.0 + K / Q + K * K;
+
+    return { 1.f, -2.f, 1.f, float(2.0 * (K * K - 1.0) / a0), float((1.0 - K / Q + K * K) / a0) };
+}
+
+namespace {
+
+//|H(e^jw)|^2 of one section, from cos(w) and cos(2w)
+double getPowerResponse(const BiquadCoefficients& c, double cosOmega, double cos2Omega) {
+    double b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+
+    auto numerator = b0 * b0 + b1 * b1 + b2 * b2 + 2.0 * (b0 * b1 + b1 * b2) * cosOmega + 2.0 * b0 * b2 * cos2Omega;
+    auto denominator = 1.0 + a1 * a1 + a2 * a2 + 2.0 * (a1 + a1 * a2) * cosOmega + 2.0 * a2 * cos2Omega;
+
+    //a zero on the unit circle can round a little below 0
+    return std::max(numerator, 0.0) / denominator;
+}
+
+}
+
+void prepareLoudnessGrid(LoudnessGrid& grid, double sampleRate) {
+    auto shelf = designKWeightingShelf(sampleRate);
+    auto highPass = designKWeightingHighPass(sampleRate);
+    auto highest = std::min(20000.0, sampleRate * 0.49);
+
+    grid.numPoints = 0;
+    double sums[numLoudnessWeightings]{};
+
+    for (int i = 0; i < LoudnessGrid::maxPoints; ++i) {
+        auto frequency = 20.0 * std::pow(2.0, i / 6.0);
+        if (frequency > highest)
+            break;
+
+        auto omega = 2.0 * pi * frequency / sampleRate;
+        auto n = grid.numPoints++;
+        grid.cosOmega[n] = std::cos(omega);
+        grid.cos2Omega[n] = std::cos(2.0 * omega);
+
+        grid.weights[Weighting_Pink][n] = 1.0;
+        grid.weights[Weighting_K][n] = getPowerResponse(shelf, grid.cosOmega[n], grid.cos2Omega[n])
+                                     * getPowerResponse(highPass, grid.cosOmega[n], grid.cos2Omega[n]);
+
+        for (int w = 0; w < numLoudnessWeightings; ++w)
+            sums[w] += grid.weights[w][n];
+    }
+
+    for (int w = 0; w < numLoudnessWeightings; ++w)
+        for (int n = 0; n < grid.numPoints; ++n)
+            grid.weights[w][n] /= sums[w];
+}
+
+double getLoudnessChangeInDecibels(const ChainCoefficients& chain, const LoudnessGrid& grid, LoudnessWeighting weighting) {
+    if (grid.numPoints == 0)
+        return 0.0;
+
+    double power = 0;
+
+    for (int n = 0; n < grid.numPoints; ++n) {
+        auto response = grid.weights[weighting][n];
+
+        for (int s = 0; s < numChainSections; ++s) {
+            if (chain.isActive(s))
+                response *= getPowerResponse(chain.sections[s], grid.cosOmega[n], grid.cos2Omega[n]);
+        }
+
+        power += response;
+    }
+
+    //a chain that cuts everything would ask for infinite gain
+    return 10.0 * std::log10(std::max(power, 1.0e-12));
+}
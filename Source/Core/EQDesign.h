@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    EQDesign.h
+    Filter settings and coefficient design for the SimpleEQ chain.
+    Plain C++, no JUCE dependency, so it can be built into SimpleEQCore.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+enum Slope {
+    Slope_12 = 0,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+struct ChainSettings {
+    float peakFreq{ 750.f }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
+    float lowCutFreq{ 20.f }, highCutFreq{ 20000.f };
+
+    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+
+    //dynamic peak: above the threshold the band's gain is pulled down like a compressor
+    bool peakDynamic{ false }, peakSidechain{ false };
+    float peakThreshold{ -24.f }, peakRatio{ 4.f }, peakAttack{ 5.f }, peakRelease{ 100.f }; //dB, x:1, ms, ms
+};
+
+inline bool operator==(const ChainSettings& a, const ChainSettings& b) {
+    return a.peakFreq == b.peakFreq && a.peakGainInDecibels == b.peakGainInDecibels && a.peakQuality == b.peakQuality
+        && a.lowCutFreq == b.lowCutFreq && a.highCutFreq == b.highCutFreq
+        && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope
+        && a.peakDynamic == b.peakDynamic && a.peakSidechain == b.peakSidechain
+        && a.peakThreshold == b.peakThreshold && a.peakRatio == b.peakRatio
+        && a.peakAttack == b.peakAttack && a.peakRelease == b.peakRelease;
+}
+
+inline bool operator!=(const ChainSettings& a, const ChainSettings& b) { return !(a == b); }
+
+//how the two parameter sets map onto a stereo pair: linked runs both channels on the first,
+//dual mono gives left the first and right the second, mid/side the same for mid and side
+enum StereoMode {
+    Stereo_Linked = 0,
+    Stereo_DualMono,
+    Stereo_MidSide
+};
+
+constexpr int numParameterSets = 2;
+
+enum ChainPositions {
+    LowCut,
+    Peak,
+    HighCut
+};
+
+constexpr int maxCutSections = 4;
+constexpr int numChainSections = maxCutSections * 2 + 1;
+
+//index of a biquad inside ChainCoefficients::sections
+constexpr int getSectionIndex(ChainPositions position, int stage = 0) {
+    return position == LowCut ? stage
+         : position == Peak   ? maxCutSections
+                              : maxCutSections + 1 + stage;
+}
+
+//normalised biquad (a0 == 1), same layout juce::dsp::IIR::Filter runs in TDF-II
+struct BiquadCoefficients {
+    float b0{ 1.f }, b1{ 0.f }, b2{ 0.f }, a1{ 0.f }, a2{ 0.f };
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+};
+
+//every section of the chain: low cut stages, peak, high cut stages
+struct ChainCoefficients {
+    BiquadCoefficients sections[numChainSections];
+    uint32_t activeSections{ 0 }; //bit n set when sections[n] is in use
+
+    bool isActive(int index) const { return ((activeSections >> index) & 1u) != 0; }
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+};
+
+BiquadCoefficients designPeakFilter(const ChainSettings& chainSettings, double sampleRate);
+
+//butterworth cuts, one biquad per 12 dB/Oct; returns the number of sections written
+int designLowCutFilter(const ChainSettings& chainSettings, double sampleRate, BiquadCoefficients* sections);
+int designHighCutFilter(const ChainSettings& chainSettings, double sampleRate, BiquadCoefficients* sections);
+
+void designChain(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chain);
+
+//everything the dynamic peak needs that doesn't depend on the momentary gain.
+//the peak biquad is linear in A and 1/A, so a new gain costs one exp and one divide
+struct DynamicPeakDesign {
+    float cosOmega{ 1.f }, alpha{ 0.f };
+    float staticGainInDecibels{ 0.f }, threshold{ 0.f }, slope{ 0.f }; //slope = 1 - 1/ratio
+    float attackCoefficient{ 0.f }, releaseCoefficient{ 0.f };
+    BiquadCoefficients detector; //band pass at the peak, 0 dB at centre
+};
+
+DynamicPeakDesign designDynamicPeak(const ChainSettings& chainSettings, double sampleRate);
+
+BiquadCoefficients makeDynamicPeak(const DynamicPeakDesign& design, float gainInDecibels);
+
+//a setting designed ahead of time for one sample rate, so switching to it costs a copy
+struct ChainDesign {
+    ChainSettings settings;
+    ChainCoefficients coefficients;
+    DynamicPeakDesign dynamicPeak;
+    double sampleRate{ 0 };
+};
+
+void designChain(const ChainSettings& chainSettings, double sampleRate, ChainDesign& design);
+
+//morph between two settings in the domain the knobs work in: frequencies, Q, ratio and times
+//geometrically, gains and threshold linearly in dB. slopes and switches jump at the half way point
+ChainSettings interpolateSettings(const ChainSettings& a, const ChainSettings& b, float amount);
+
+//BS.1770 K-weighting: the head related high shelf and the RLB high pass, for any sample rate
+BiquadCoefficients designKWeightingShelf(double sampleRate);
+BiquadCoefficients designKWeightingHighPass(double sampleRate);
+
+//what the loudness of a whole chain is judged against: pink noise, optionally heard through K-weighting
+enum LoudnessWeighting {
+    Weighting_Pink = 0,
+    Weighting_K
+};
+
+constexpr int numLoudnessWeightings = 2;
+
+//1/6 octave points from 20 Hz to 20 kHz (or just below nyquist), worked out once per sample rate.
+//pink noise has the same power in every 1/6 octave, so it weights the points equally; each
+//weighting sums to 1
+struct LoudnessGrid {
+    static constexpr int maxPoints = 60;
+
+    double cosOmega[maxPoints]{}, cos2Omega[maxPoints]{};
+    double weights[numLoudnessWeightings][maxPoints]{};
+    int numPoints{ 0 };
+};
+
+void prepareLoudnessGrid(LoudnessGrid& grid, double sampleRate);
+
+//how much louder, in dB, weighted noise comes out of the chain than went in. works on |H|^2 as
+//polynomials in cos(w), so it takes no trig and no complex maths per point
+double getLoudnessChangeInDecibels(const ChainCoefficients& chain, const LoudnessGrid& grid,
+                                   LoudnessWeighting weighting = Weighting_K);
@@ -0,0 +1,630 @@
+/*
+  ==============================================================================
+
+    EQEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "EQEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <new>
+
+namespace {
+
+size_t alignUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+//same threshold as juce::dsp::util::snapToZero
+inline void snapToZero(float& value) {
+    if (!(value < -1.0e-8f || value > 1.0e-8f))
+        value = 0.f;
+}
+
+//a straight line from gain to target over the first remaining samples, then target
+struct GainRamp {
+    float gain, step, target;
+    int remaining;
+
+    float at(int n) const { return n < remaining ? gain + step * float(n) : target; }
+};
+
+constexpr int maxWavefrontLanes = (numChainSections + LaneVector::size - 1) / LaneVector::size * LaneVector::size;
+
+//one channel's sections laid out across lanes, lane g running the g-th section
+struct WavefrontLanes {
+    alignas(16) float b0[maxWavefrontLanes], b1[maxWavefrontLanes], b2[maxWavefrontLanes];
+    alignas(16) float a1[maxWavefrontLanes], a2[maxWavefrontLanes];
+    alignas(16) float s1[maxWavefrontLanes], s2[maxWavefrontLanes];
+};
+
+template <int numVectors>
+struct Wavefront {
+    static constexpr int depth = numVectors * LaneVector::size;
+
+    LaneVector b0[numVectors], b1[numVectors], b2[numVectors], a1[numVectors], a2[numVectors];
+    LaneVector s1[numVectors], s2[numVectors], y[numVectors];
+
+    //x enters lane 0 and every other lane takes what the lane below it put out last step.
+    //only lanes low to high hold a real sample, the rest keep their state while the wavefront fills and drains
+    template <bool partial>
+    void step(float x, int low, int high) {
+        LaneVector in[numVectors];
+        in[0] = LaneVector::shiftUp(y[0], LaneVector::broadcast(x));
+        for (int v = 1; v < numVectors; ++v)
+            in[v] = LaneVector::shiftUp(y[v], y[v - 1]);
+
+        for (int v = 0; v < numVectors; ++v) {
+            y[v] = b0[v] * in[v] + s1[v];
+            auto newS1 = b1[v] * in[v] - a1[v] * y[v] + s2[v];
+            auto newS2 = b2[v] * in[v] - a2[v] * y[v];
+
+            if (partial) {
+                auto first = v * LaneVector::size;
+                auto below = std::clamp(low - first, 0, LaneVector::size);
+                auto upTo = std::clamp(high + 1 - first, 0, LaneVector::size);
+
+                newS1 = LaneVector::selectFirst(below, s1[v], LaneVector::selectFirst(upTo, newS1, s1[v]));
+                newS2 = LaneVector::selectFirst(below, s2[v], LaneVector::selectFirst(upTo, newS2, s2[v]));
+            }
+
+            s1[v] = newS1;
+            s2[v] = newS2;
+        }
+    }
+
+    //a sample comes out of the last lane depth - 1 steps after it went in, and takes the gain on the way out
+    void run(float* samples, int stride, int numSamples, const GainRamp& ramp, int start) {
+        auto numSteps = numSamples + depth - 1;
+        int n = 0;
+
+        for (; n < depth - 1; ++n) {
+            step<true>(n < numSamples ? samples[n * stride] : 0.f, std::max(0, n - numSamples + 1), n);
+        }
+
+        for (; n < numSamples; ++n) {
+            step<false>(samples[n * stride], 0, 0);
+            samples[(n - depth + 1) * stride] = y[numVectors - 1].getLast() * ramp.at(start + n - depth + 1);
+        }
+
+        for (; n < numSteps; ++n) {
+            step<true>(0.f, n - numSamples + 1, n);
+            samples[(n - depth + 1) * stride] = y[numVectors - 1].getLast() * ramp.at(start + n - depth + 1);
+        }
+    }
+
+    void process(WavefrontLanes& lanes, float* samples, int stride, int numSamples, const GainRamp& ramp, int start) {
+        for (int v = 0; v < numVectors; ++v) {
+            auto offset = v * LaneVector::size;
+            b0[v] = LaneVector::load(lanes.b0 + offset);
+            b1[v] = LaneVector::load(lanes.b1 + offset);
+            b2[v] = LaneVector::load(lanes.b2 + offset);
+            a1[v] = LaneVector::load(lanes.a1 + offset);
+            a2[v] = LaneVector::load(lanes.a2 + offset);
+            s1[v] = LaneVector::load(lanes.s1 + offset);
+            s2[v] = LaneVector::load(lanes.s2 + offset);
+            y[v] = LaneVector::broadcast(0.f);
+        }
+
+        run(samples, stride, numSamples, ramp, start);
+
+        for (int v = 0; v < numVectors; ++v) {
+            s1[v].store(lanes.s1 + v * LaneVector::size);
+            s2[v].store(lanes.s2 + v * LaneVector::size);
+        }
+    }
+};
+
+}
+
+size_t EQEngine::getRequiredMemorySize(int maxChannels) {
+    auto channels = size_t(std::max(maxChannels, 0));
+    auto laneStateSize = sizeof(LaneState) * numChainSections * size_t(getNumLaneGroups(int(channels)));
+    auto detectorStateSize = sizeof(float) * 2 * channels;
+
+    return alignUp(sizeof(EQEngine), memoryAlignment) + alignUp(laneStateSize, memoryAlignment)
+         + alignUp(detectorStateSize, memoryAlignment);
+}
+
+EQEngine* EQEngine::create(void* memory, size_t memorySize, int maxChannels) {
+    if (memory == nullptr || maxChannels <= 0)
+        return nullptr;
+
+    if (reinterpret_cast<std::uintptr_t>(memory) % memoryAlignment != 0)
+        return nullptr;
+
+    if (memorySize < getRequiredMemorySize(maxChannels))
+        return nullptr;
+
+    auto* bytes = static_cast<char*>(memory) + alignUp(sizeof(EQEngine), memoryAlignment);
+    auto* laneState = reinterpret_cast<LaneState*>(bytes);
+    auto* detectorState = reinterpret_cast<float*>(bytes + alignUp(sizeof(LaneState) * numChainSections * getNumLaneGroups(maxChannels),
+                                                                   memoryAlignment));
+
+    return new (memory) EQEngine(maxChannels, laneState, detectorState);
+}
+
+EQEngine::EQEngine(int maxChannelsToUse, LaneState* laneStateToUse, float* detectorStateToUse)
+    : maxChannels(maxChannelsToUse), numChannels(maxChannelsToUse), laneState(laneStateToUse), detectorState(detectorStateToUse)
+{
+    reset();
+    updateLaneCoefficients();
+}
+
+bool EQEngine::prepare(double newSampleRate, int newMaxBlockSize, int newNumChannels) {
+    if (newSampleRate <= 0 || newMaxBlockSize <= 0 || newNumChannels <= 0 || newNumChannels > maxChannels)
+        return false;
+
+    sampleRate = newSampleRate;
+    maxBlockSize = newMaxBlockSize;
+    numChannels = newNumChannels;
+
+    prepareLoudnessGrid(loudnessGrid, sampleRate);
+    gainRampLength = std::max(1, int(std::lround(sampleRate * gainRampSeconds)));
+
+    designAll();
+    reset();
+
+    return true;
+}
+
+void EQEngine::reset() {
+    std::fill(laneState, laneState + numChainSections * getNumLaneGroups(maxChannels), LaneState{});
+    std::fill(detectorState, detectorState + maxChannels * 2, 0.f);
+    std::fill(std::begin(envelope), std::end(envelope), 0.f);
+
+    //nothing to ramp from after a reset
+    std::copy(std::begin(laneGainTarget), std::end(laneGainTarget), laneGain);
+    std::fill(std::begin(laneGainStep), std::end(laneGainStep), 0.f);
+    gainRampRemaining = 0;
+}
+
+bool EQEngine::setParameters(const ChainSettings& chainSettings, int parameterSet) {
+    if (parameterSet < 0 || parameterSet >= numParameterSets || chainSettings == settings[parameterSet])
+        return false;
+
+    settings[parameterSet] = chainSettings;
+
+    if (sampleRate > 0 && isSetInUse(parameterSet)) {
+        designSet(parameterSet);
+        updateLaneCoefficients();
+    }
+
+    return true;
+}
+
+void EQEngine::setStereoMode(StereoMode newMode) {
+    if (newMode == stereoMode)
+        return;
+
+    //the second set isn't kept up to date while nothing uses it
+    auto wasInUse = isSetInUse(1);
+    stereoMode = newMode;
+
+    if (sampleRate > 0 && isSetInUse(1) && !wasInUse)
+        designSet(1);
+
+    updateLaneCoefficients();
+}
+
+void EQEngine::setAutoGain(bool shouldBeEnabled, LoudnessWeighting weighting) {
+    if (shouldBeEnabled == autoGain && weighting == autoGainWeighting)
+        return;
+
+    autoGain = shouldBeEnabled;
+    autoGainWeighting = weighting;
+    updateGainTargets();
+}
+
+void EQEngine::setOutputGain(float gainInDecibels) {
+    if (gainInDecibels == outputGainInDecibels)
+        return;
+
+    outputGainInDecibels = gainInDecibels;
+    updateGainTargets();
+}
+
+void EQEngine::setDesign(const ChainDesign& design) {
+    if (design.sampleRate != sampleRate) {
+        setParameters(design.settings);
+        return;
+    }
+
+    settings[0] = design.settings;
+    coefficients[0] = design.coefficients;
+    dynamicPeak[0] = design.dynamicPeak;
+
+    updateLaneCoefficients();
+}
+
+//the first set always from scratch, the second from the first if they match
+void EQEngine::designAll() {
+    designChain(settings[0], sampleRate, coefficients[0]);
+    dynamicPeak[0] = designDynamicPeak(settings[0], sampleRate);
+
+    if (isSetInUse(1))
+        designSet(1);
+
+    updateLaneCoefficients();
+}
+
+//one design per distinct setting: a set that matches the other, up to date one is copied
+void EQEngine::designSet(int parameterSet) {
+    auto other = 1 - parameterSet;
+
+    if (isSetInUse(other) && settings[other] == settings[parameterSet]) {
+        coefficients[parameterSet] = coefficients[other];
+        dynamicPeak[parameterSet] = dynamicPeak[other];
+        return;
+    }
+
+    designChain(settings[parameterSet], sampleRate, coefficients[parameterSet]);
+    dynamicPeak[parameterSet] = designDynamicPeak(settings[parameterSet], sampleRate);
+}
+
+//spreads each set's coefficients over the lanes that run it. a section only one set
+//uses is pass through (b0 = 1) in the other set's lanes
+void EQEngine::updateLaneCoefficients() {
+    laneActiveSections = 0;
+
+    for (int set = 0; set < numParameterSets; ++set) {
+        if (isSetInUse(set))
+            laneActiveSections |= coefficients[set].activeSections;
+    }
+
+    for (int s = 0; s < numChainSections; ++s) {
+        for (int l = 0; l < lanes; ++l) {
+            const auto& chain = coefficients[getParameterSet(l)];
+            laneCoefficients[s].setLane(l, chain.isActive(s) ? chain.sections[s] : BiquadCoefficients{});
+        }
+    }
+
+    updateGainTargets();
+}
+
+//every coefficient change ends up here, so the loudness of a chain is only worked out when it
+//changes. a new target starts a ramp from wherever the gain is now; one that comes while a ramp
+//is running (a morph moves it every slice) steers that ramp over what's left of it instead of
+//starting over, but never over less than a quarter of the ramp, so the gain can't jump
+void EQEngine::updateGainTargets() {
+    for (int set = 0; set < numParameterSets; ++set) {
+        auto change = autoGain && sampleRate > 0 && isSetInUse(set)
+                    ? getLoudnessChangeInDecibels(coefficients[set], loudnessGrid, autoGainWeighting) : 0.0;
+        compensation[set] = std::clamp(-float(change), -maxCompensationInDecibels, maxCompensationInDecibels);
+    }
+
+    float targets[numParameterSets];
+    for (int set = 0; set < numParameterSets; ++set)
+        targets[set] = std::pow(10.f, (outputGainInDecibels + compensation[set]) * 0.05f);
+
+    auto changed = false;
+    unityGain = true;
+
+    for (int l = 0; l < lanes; ++l) {
+        auto target = targets[getParameterSet(l)];
+        changed |= target != laneGainTarget[l];
+        unityGain &= target == 1.f;
+        laneGainTarget[l] = target;
+    }
+
+    if (!changed)
+        return;
+
+    auto length = gainRampRemaining > 0 ? std::max({ gainRampRemaining, gainRampLength / 4, 1 }) : gainRampLength;
+
+    for (int l = 0; l < lanes; ++l)
+        laneGainStep[l] = (laneGainTarget[l] - laneGain[l]) / float(length);
+
+    gainRampRemaining = length;
+}
+
+void EQEngine::processPlanar(float* const* channels, int numChannelsToProcess, int numSamples,
+                             const float* const* sidechain, int numSidechainChannels) {
+    process([channels](int ch) { return channels[ch]; }, std::min(numChannelsToProcess, numChannels), 1, numSamples,
+            sidechain, numSidechainChannels);
+}
+
+void EQEngine::processInterleaved(float* samples, int numFrames) {
+    process([samples](int ch) { return samples + ch; }, numChannels, numChannels, numFrames, nullptr, 0);
+}
+
+template <typename ChannelAccess>
+void EQEngine::process(ChannelAccess channelData, int numChannelsToProcess, int stride, int numSamples,
+                       const float* const* sidechain, int numSidechainChannels) {
+    const int peak = getSectionIndex(Peak);
+    auto numGroups = getNumLaneGroups(numChannelsToProcess);
+    auto dynamic = isDynamic(0) || isDynamic(1);
+
+    //without the dynamic peak nothing has to happen between the sections, so the whole block goes at once
+    if (!dynamic) {
+        for (int g = 0; g < numGroups; ++g)
+            processGroup(channelData, numChannelsToProcess, stride, 0, numSamples, g, 0, numChainSections, true, true);
+    }
+    else {
+        for (int start = 0; start < numSamples; start += dynamicControlInterval) {
+            auto length = std::min(dynamicControlInterval, numSamples - start);
+
+            //the detector listens to the peak's input, so everything before it runs first.
+            //in between the buffer holds mid/side, the detector wants it that way
+            for (int g = 0; g < numGroups; ++g)
+                processGroup(channelData, numChannelsToProcess, stride, start, length, g, 0, peak, true, false);
+
+            updateDynamicPeak(channelData, numChannelsToProcess, stride, start, length, sidechain, numSidechainChannels);
+
+            for (int g = 0; g < numGroups; ++g)
+                processGroup(channelData, numChannelsToProcess, stride, start, length, g, peak, numChainSections, false, true);
+        }
+    }
+
+    for (int g = 0; g < getNumLaneGroups(maxChannels); ++g) {
+        for (int s = 0; s < numChainSections; ++s)
+            getLaneState(g)[s].snapToZero();
+    }
+
+    for (int ch = 0; ch < maxChannels * 2; ++ch)
+        snapToZero(detectorState[ch]);
+
+    for (auto& env : envelope)
+        snapToZero(env);
+
+    if (gainRampRemaining > 0) {
+        auto ramped = std::min(numSamples, gainRampRemaining);
+        gainRampRemaining -= ramped;
+
+        for (int l = 0; l < lanes; ++l)
+            laneGain[l] = gainRampRemaining > 0 ? laneGain[l] + laneGainStep[l] * float(ramped) : laneGainTarget[l];
+    }
+}
+
+//gathers up to four channels into lanes, runs the sections and scatters them back, a chunk at a time.
+//mid/side is encoded on the way in and decoded on the way out, nothing else touches the buffer
+template <typename ChannelAccess>
+void EQEngine::processGroup(ChannelAccess channelData, int numChannelsToProcess, int stride, int start, int length,
+                            int group, int firstSection, int endSection, bool encode, bool decode) {
+    auto firstChannel = group * lanes;
+    auto numLanes = std::min(lanes, numChannelsToProcess - firstChannel);
+
+    //a lone channel has no partner to encode or decode with
+    if (numLanes == 1 && wavefront) {
+        processWavefront(channelData(firstChannel) + start * stride, stride, start, length, getLaneState(group), firstSection, endSection);
+        return;
+    }
+
+    for (int chunk = start; chunk < start + length; chunk += dynamicControlInterval)
+        processGroupChunk(channelData, numChannelsToProcess, stride, chunk, std::min(dynamicControlInterval, start + length - chunk),
+                          group, firstSection, endSection, encode, decode);
+}
+
+template <typename ChannelAccess>
+void EQEngine::processGroupChunk(ChannelAccess channelData, int numChannelsToProcess, int stride, int start, int length,
+                                 int group, int firstSection, int endSection, bool encode, bool decode) {
+    alignas(16) float block[dynamicControlInterval][lanes]{};
+
+    auto firstChannel = group * lanes;
+    auto numLanes = std::min(lanes, numChannelsToProcess - firstChannel);
+    auto midSide = stereoMode == Stereo_MidSide;
+
+    for (int l = 0; l < numLanes; l += 2) {
+        const auto* a = channelData(firstChannel + l) + start * stride;
+
+        if (l + 1 == numLanes) {
+            for (int i = 0; i < length; ++i)
+                block[i][l] = a[i * stride];
+            continue;
+        }
+
+        const auto* b = channelData(firstChannel + l + 1) + start * stride;
+
+        if (midSide && encode) {
+            for (int i = 0; i < length; ++i) {
+                block[i][l] = 0.5f * (a[i * stride] + b[i * stride]);
+                block[i][l + 1] = 0.5f * (a[i * stride] - b[i * stride]);
+            }
+        }
+        else {
+            for (int i = 0; i < length; ++i) {
+                block[i][l] = a[i * stride];
+                block[i][l + 1] = b[i * stride];
+            }
+        }
+    }
+
+    processLanes(block, length, getLaneState(group), firstSection, endSection);
+
+    //the gain goes on at the end of the chain, before mid/side is decoded
+    if (endSection == numChainSections && isGainNeeded())
+        applyGain(block, start, length);
+
+    for (int l = 0; l < numLanes; l += 2) {
+        auto* a = channelData(firstChannel + l) + start * stride;
+
+        if (l + 1 == numLanes) {
+            for (int i = 0; i < length; ++i)
+                a[i * stride] = block[i][l];
+            continue;
+        }
+
+        auto* b = channelData(firstChannel + l + 1) + start * stride;
+
+        if (midSide && decode) {
+            for (int i = 0; i < length; ++i) {
+                a[i * stride] = block[i][l] + block[i][l + 1];
+                b[i * stride] = block[i][l] - block[i][l + 1];
+            }
+        }
+        else {
+            for (int i = 0; i < length; ++i) {
+                a[i * stride] = block[i][l];
+                b[i * stride] = block[i][l + 1];
+            }
+        }
+    }
+}
+
+//one section at a time over the block like ProcessorChain does, all lanes at once
+void EQEngine::processLanes(float (*block)[lanes], int numSamples, LaneState* state, int firstSection, int endSection) {
+    for (int s = firstSection; s < endSection; ++s) {
+        if (((laneActiveSections >> s) & 1u) == 0)
+            continue;
+
+        processLaneBiquad(laneCoefficients[s], state[s], block, numSamples);
+    }
+}
+
+//same arithmetic per sample as GainRamp::at, so the wavefront comes out the same
+void EQEngine::applyGain(float (*block)[lanes], int start, int numSamples) const {
+    auto gain = LaneVector::load(laneGain), step = LaneVector::load(laneGainStep), target = LaneVector::load(laneGainTarget);
+    auto ramped = std::clamp(gainRampRemaining - start, 0, numSamples);
+    int i = 0;
+
+    for (; i < ramped; ++i)
+        (LaneVector::load(block[i]) * (gain + step * LaneVector::broadcast(float(start + i)))).store(block[i]);
+
+    for (; i < numSamples; ++i)
+        (LaneVector::load(block[i]) * target).store(block[i]);
+}
+
+//a lone channel can't fill the lanes, so its sections fill them instead, as a wavefront where
+//each lane runs one sample behind the lane below. every section does the same arithmetic in the
+//same order as in processLanes, so the output is bit-identical. filling and draining takes
+//(lanes in use - 1) extra steps per call, which is why the static chain goes a whole block at once
+void EQEngine::processWavefront(float* samples, int stride, int start, int numSamples, LaneState* state, int firstSection, int endSection) {
+    int sections[numChainSections];
+    int numSections = 0;
+
+    for (int s = firstSection; s < endSection; ++s)
+        if (((laneActiveSections >> s) & 1u) != 0)
+            sections[numSections++] = s;
+
+    if (numSamples <= 0)
+        return;
+
+    //a lone channel is always the first lane of its group; before the end of the chain, and
+    //without anything to do there, the gain is 1 and changes nothing
+    auto ramp = endSection == numChainSections && isGainNeeded()
+              ? GainRamp{ laneGain[0], laneGainStep[0], laneGainTarget[0], gainRampRemaining }
+              : GainRamp{ 1.f, 0.f, 1.f, 0 };
+
+    if (numSections == 0) {
+        for (int i = 0; i < numSamples; ++i)
+            samples[i * stride] *= ramp.at(start + i);
+        return;
+    }
+
+    //the lanes past the last section pass samples through untouched
+    WavefrontLanes wave{};
+    std::fill(std::begin(wave.b0), std::end(wave.b0), 1.f);
+
+    for (int g = 0; g < numSections; ++g) {
+        const auto& c = laneCoefficients[sections[g]];
+        wave.b0[g] = c.b0[0];
+        wave.b1[g] = c.b1[0];
+        wave.b2[g] = c.b2[0];
+        wave.a1[g] = c.a1[0];
+        wave.a2[g] = c.a2[0];
+        wave.s1[g] = state[sections[g]].s1[0];
+        wave.s2[g] = state[sections[g]].s2[0];
+    }
+
+    static_assert(maxWavefrontLanes == 3 * lanes, "one case per number of vectors");
+
+    switch ((numSections + lanes - 1) / lanes) {
+        case 1: Wavefront<1>().process(wave, samples, stride, numSamples, ramp, start); break;
+        case 2: Wavefront<2>().process(wave, samples, stride, numSamples, ramp, start); break;
+        default: Wavefront<3>().process(wave, samples, stride, numSamples, ramp, start); break;
+    }
+
+    for (int g = 0; g < numSections; ++g) {
+        state[sections[g]].s1[0] = wave.s1[g];
+        state[sections[g]].s2[0] = wave.s2[g];
+    }
+}
+
+//the envelope is followed every sample, linked across the channels of a set; the peak's
+//coefficients move once per dynamicControlInterval, in the lanes of that set only
+template <typename ChannelAccess>
+void EQEngine::updateDynamicPeak(ChannelAccess channelData, int numChannelsToProcess, int stride, int start, int length,
+                                 const float* const* sidechain, int numSidechainChannels) {
+    const int peak = getSectionIndex(Peak);
+
+    for (int set = 0; set < numParameterSets; ++set) {
+        if (!isDynamic(set))
+            continue;
+
+        const auto& d = dynamicPeak[set];
+        auto loudest = envelope[set];
+        auto first = true;
+
+        //every channel follows on from the envelope the last slice ended with, not from the
+        //channel before it, so linking them doesn't speed up the attack
+        auto follow = [&](float* state, auto input) {
+            auto s1 = state[0], s2 = state[1];
+            auto env = envelope[set];
+
+            for (int i = 0; i < length; ++i) {
+                auto x = input(i);
+                auto y = d.detector.b0 * x + s1;
+                s1 = d.detector.b1 * x - d.detector.a1 * y + s2;
+                s2 = d.detector.b2 * x - d.detector.a2 * y;
+
+                auto level = std::abs(y);
+                auto coefficient = level > env ? d.attackCoefficient : d.releaseCoefficient;
+                env = level + coefficient * (env - level);
+            }
+
+            state[0] = s1;
+            state[1] = s2;
+
+            //linked: the loudest channel drives the band
+            if (first || env > loudest)
+                loudest = env;
+            first = false;
+        };
+
+        auto useSidechain = settings[set].peakSidechain && sidechain != nullptr && numSidechainChannels > 0;
+
+        if (!useSidechain) {
+            //the main signal is already mid/side here when it has to be
+            for (int ch = 0; ch < numChannelsToProcess; ++ch) {
+                if (getParameterSet(ch) != set)
+                    continue;
+
+                const auto* input = channelData(ch) + start * stride;
+                follow(getDetectorState(ch), [input, stride](int i) { return input[i * stride]; });
+            }
+        }
+        else if (stereoMode == Stereo_Linked) {
+            for (int ch = 0; ch < std::min(numSidechainChannels, maxChannels); ++ch) {
+                const auto* input = sidechain[ch] + start;
+                follow(getDetectorState(ch), [input](int i) { return input[i]; });
+            }
+        }
+        else if (stereoMode == Stereo_MidSide && numSidechainChannels > 1) {
+            const auto* left = sidechain[0] + start;
+            const auto* right = sidechain[1] + start;
+            auto sign = set == 0 ? 1.f : -1.f;
+            follow(getDetectorState(set), [left, right, sign](int i) { return 0.5f * (left[i] + sign * right[i]); });
+        }
+        else {
+            //a mono sidechain feeds both sets
+            const auto* input = sidechain[std::min(set, numSidechainChannels - 1)] + start;
+            follow(getDetectorState(set), [input](int i) { return input[i]; });
+        }
+
+        envelope[set] = loudest;
+
+        auto envelopeInDecibels = 20.f * std::log10(loudest + 1.0e-9f);
+        auto overshoot = std::max(envelopeInDecibels - d.threshold, 0.f);
+        auto c = makeDynamicPeak(d, std::clamp(d.staticGainInDecibels - overshoot * d.slope, -48.f, 24.f));
+
+        for (int l = 0; l < lanes; ++l) {
+            if (getParameterSet(l) == set)
+                laneCoefficients[peak].setLane(l, c);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    EQEngine.h
+    The SimpleEQ filter chain for any number of channels, living entirely
+    inside one caller-provided block of memory. Nothing is allocated here.
+
+    Channels run side by side in groups of four SIMD lanes, and every lane
+    has its own copy of the coefficients, so dual mono and mid/side go
+    through the same kernel as linked stereo and cost about the same.
+    A channel left alone in its group (mono, or the odd one out) instead
+    spreads its sections across the lanes as a wavefront.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "EQDesign.h"
+#include "LaneBiquad.h"
+
+#include <cstddef>
+
+class EQEngine
+{
+public:
+    static constexpr size_t memoryAlignment = 64;
+
+    static size_t getRequiredMemorySize(int maxChannels);
+
+    //builds an engine at the start of memory; returns nullptr if the block is too small or misaligned
+    static EQEngine* create(void* memory, size_t memorySize, int maxChannels);
+
+    bool prepare(double sampleRate, int maxBlockSize, int numChannels);
+    void reset();
+
+    //designs new coefficients, state is kept so changes don't click.
+    //returns false without redesigning if nothing changed. the second set is only designed
+    //while a stereo mode uses it, and is copied rather than designed when both sets match
+    bool setParameters(const ChainSettings& chainSettings, int parameterSet = 0);
+    const ChainSettings& getParameters(int parameterSet = 0) const { return settings[parameterSet]; }
+
+    //dual mono and mid/side work on pairs of channels (0 and 1, 2 and 3, ...);
+    //a channel without a partner runs on the first set
+    void setStereoMode(StereoMode newMode);
+    StereoMode getStereoMode() const { return stereoMode; }
+
+    //takes a design made ahead of time for the first set; only redesigns if it was made for another sample rate
+    void setDesign(const ChainDesign& design);
+
+    //auto gain turns each set's output by the opposite of its chain's loudness change (clamped to
+    //maxCompensationInDecibels), worked out from the coefficients whenever they change. the dynamic
+    //peak counts at its static gain. output gain goes on top; both ramp over gainRampSeconds, and a
+    //change while a ramp runs steers it over what's left, no less than a quarter of gainRampSeconds
+    void setAutoGain(bool shouldBeEnabled, LoudnessWeighting weighting = Weighting_K);
+    bool isAutoGainEnabled() const { return autoGain; }
+    LoudnessWeighting getAutoGainWeighting() const { return autoGainWeighting; }
+
+    void setOutputGain(float gainInDecibels);
+    float getOutputGain() const { return outputGainInDecibels; }
+
+    //0 while auto gain is off
+    float getCompensationInDecibels(int parameterSet = 0) const { return compensation[parameterSet]; }
+
+    static constexpr float maxCompensationInDecibels = 24.f;
+    static constexpr double gainRampSeconds = 0.05;
+
+    //on by default; off runs a lone channel through the lane kernel too, for comparing the two
+    void setWavefrontEnabled(bool shouldBeEnabled) { wavefront = shouldBeEnabled; }
+    bool isWavefrontEnabled() const { return wavefront; }
+    const ChainCoefficients& getCoefficients(int parameterSet = 0) const { return coefficients[parameterSet]; }
+
+    double getSampleRate() const { return sampleRate; }
+    int getNumChannels() const { return numChannels; }
+    int getMaxChannels() const { return maxChannels; }
+    int getMaxBlockSize() const { return maxBlockSize; }
+
+    //sidechain only feeds the dynamic peak's detector, and only when peakSidechain is set.
+    //linked, every sidechain channel drives the band; otherwise each set hears its own channel
+    void processPlanar(float* const* channels, int numChannelsToProcess, int numSamples,
+                       const float* const* sidechain = nullptr, int numSidechainChannels = 0);
+    void processInterleaved(float* samples, int numFrames);
+
+    //the dynamic peak recomputes its coefficients once per this many samples
+    static constexpr int dynamicControlInterval = 32;
+
+    static constexpr int lanes = LaneBiquadCoefficients::lanes;
+
+private:
+    using LaneCoefficients = LaneBiquadCoefficients;
+    using LaneState = LaneBiquadState;
+
+    static int getNumLaneGroups(int channels) { return (channels + lanes - 1) / lanes; }
+
+    EQEngine(int maxChannels, LaneState* laneState, float* detectorState);
+
+    //per group of lanes, one state per chain section
+    LaneState* getLaneState(int group) { return laneState + group * numChainSections; }
+    //per channel, two for the dynamic peak's detector
+    float* getDetectorState(int channel) { return detectorState + channel * 2; }
+
+    int getParameterSet(int channel) const { return stereoMode == Stereo_Linked ? 0 : channel % 2; }
+    bool isSetInUse(int parameterSet) const { return parameterSet == 0 || (stereoMode != Stereo_Linked && numChannels > 1); }
+    bool isDynamic(int parameterSet) const { return isSetInUse(parameterSet) && settings[parameterSet].peakDynamic; }
+
+    void designAll();
+    void designSet(int parameterSet);
+    void updateLaneCoefficients();
+    void updateGainTargets();
+
+    template <typename ChannelAccess>
+    void process(ChannelAccess channelData, int numChannelsToProcess, int stride, int numSamples,
+                 const float* const* sidechain, int numSidechainChannels);
+
+    template <typename ChannelAccess>
+    void processGroup(ChannelAccess channelData, int numChannelsToProcess, int stride, int start, int length,
+                      int group, int firstSection, int endSection, bool encode, bool decode);
+
+    template <typename ChannelAccess>
+    void processGroupChunk(ChannelAccess channelData, int numChannelsToProcess, int stride, int start, int length,
+                           int group, int firstSection, int endSection, bool encode, bool decode);
+
+    void processLanes(float (*block)[lanes], int numSamples, LaneState* state, int firstSection, int endSection);
+    void processWavefront(float* samples, int stride, int start, int numSamples, LaneState* state, int firstSection, int endSection);
+
+    //start counts from the beginning of the current process() call, where the ramp is
+    void applyGain(float (*block)[lanes], int start, int numSamples) const;
+    bool isGainNeeded() const { return gainRampRemaining > 0 || !unityGain; }
+
+    template <typename ChannelAccess>
+    void updateDynamicPeak(ChannelAccess channelData, int numChannelsToProcess, int stride, int start, int length,
+                           const float* const* sidechain, int numSidechainChannels);
+
+    alignas(memoryAlignment) LaneCoefficients laneCoefficients[numChainSections];
+    uint32_t laneActiveSections{ 0 }; //sections any lane needs, the others run as pass through
+
+    ChainCoefficients coefficients[numParameterSets];
+    ChainSettings settings[numParameterSets];
+
+    DynamicPeakDesign dynamicPeak[numParameterSets];
+    float envelope[numParameterSets]{};
+
+    StereoMode stereoMode{ Stereo_Linked };
+    bool wavefront{ true };
+
+    LoudnessGrid loudnessGrid;
+    bool autoGain{ false };
+    LoudnessWeighting autoGainWeighting{ Weighting_K };
+    float outputGainInDecibels{ 0 };
+    float compensation[numParameterSets]{};
+
+    //per lane, the gain at the start of the next process() call and where it is ramping to
+    alignas(16) float laneGain[lanes]{ 1.f, 1.f, 1.f, 1.f };
+    alignas(16) float laneGainStep[lanes]{};
+    alignas(16) float laneGainTarget[lanes]{ 1.f, 1.f, 1.f, 1.f };
+    int gainRampLength{ 1 }, gainRampRemaining{ 0 };
+    bool unityGain{ true };
+
+    double sampleRate{ 0 };
+    int maxChannels{ 0 }, numChannels{ 0 }, maxBlockSize{ 0 };
+
+    //both right after this object
+    LaneState* laneState{ nullptr };  //[lane groups][numChainSections]
+    float* detectorState{ nullptr };  //[maxChannels][2]
+};
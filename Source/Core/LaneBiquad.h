@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    LaneBiquad.h
+    One TDF-II biquad over four channels side by side, every lane with its
+    own coefficients and state. EQEngine runs its chain sections through it,
+    LoudnessMeter its K-weighting.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "EQDesign.h"
+#include "LaneVector.h"
+
+struct alignas(16) LaneBiquadCoefficients {
+    static constexpr int lanes = LaneVector::size;
+
+    float b0[lanes], b1[lanes], b2[lanes], a1[lanes], a2[lanes];
+
+    void setLane(int lane, const BiquadCoefficients& c) {
+        b0[lane] = c.b0;
+        b1[lane] = c.b1;
+        b2[lane] = c.b2;
+        a1[lane] = c.a1;
+        a2[lane] = c.a2;
+    }
+
+    void setAllLanes(const BiquadCoefficients& c) {
+        for (int l = 0; l < lanes; ++l)
+            setLane(l, c);
+    }
+};
+
+struct alignas(16) LaneBiquadState {
+    float s1[LaneBiquadCoefficients::lanes], s2[LaneBiquadCoefficients::lanes];
+
+    //same threshold as juce::dsp::util::snapToZero
+    void snapToZero() {
+        for (int l = 0; l < LaneBiquadCoefficients::lanes; ++l) {
+            if (!(s1[l] < -1.0e-8f || s1[l] > 1.0e-8f)) s1[l] = 0.f;
+            if (!(s2[l] < -1.0e-8f || s2[l] > 1.0e-8f)) s2[l] = 0.f;
+        }
+    }
+};
+
+//in place over numSamples frames of one sample per lane
+inline void processLaneBiquad(const LaneBiquadCoefficients& c, LaneBiquadState& state,
+                              float (*block)[LaneBiquadCoefficients::lanes], int numSamples) {
+    auto b0 = LaneVector::load(c.b0), b1 = LaneVector::load(c.b1), b2 = LaneVector::load(c.b2);
+    auto a1 = LaneVector::load(c.a1), a2 = LaneVector::load(c.a2);
+    auto s1 = LaneVector::load(state.s1), s2 = LaneVector::load(state.s2);
+
+    for (int i = 0; i < numSamples; ++i) {
+        auto x = LaneVector::load(block[i]);
+        auto y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        y.store(block[i]);
+    }
+
+    s1.store(state.s1);
+    s2.store(state.s2);
+}
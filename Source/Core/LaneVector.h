@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    LaneVector.h
+    Four floats side by side in one SIMD register: SSE on x86, NEON on ARM,
+    a plain array anywhere else. Only what the biquad kernels need, and no
+    fused multiply-add, so every lane rounds exactly like the scalar code.
+
+    Lanes are numbered from the lowest address, so lane 0 is what load()
+    reads from p[0].
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define SIMPLEEQ_LANES_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define SIMPLEEQ_LANES_NEON 1
+#endif
+
+struct LaneVector {
+    static constexpr int size = 4;
+
+#if SIMPLEEQ_LANES_SSE
+    __m128 v;
+
+    //p has to be 16 byte aligned
+    static LaneVector load(const float* p) { return { _mm_load_ps(p) }; }
+    void store(float* p) const { _mm_store_ps(p, v); }
+    static LaneVector broadcast(float x) { return { _mm_set1_ps(x) }; }
+
+    friend LaneVector operator+(LaneVector a, LaneVector b) { return { _mm_add_ps(a.v, b.v) }; }
+    friend LaneVector operator-(LaneVector a, LaneVector b) { return { _mm_sub_ps(a.v, b.v) }; }
+    friend LaneVector operator*(LaneVector a, LaneVector b) { return { _mm_mul_ps(a.v, b.v) }; }
+
+    //{ carry[3], v[0], v[1], v[2] }
+    static LaneVector shiftUp(LaneVector v, LaneVector carry) {
+        auto t = _mm_shuffle_ps(carry.v, v.v, _MM_SHUFFLE(0, 0, 3, 3));
+        return { _mm_shuffle_ps(t, v.v, _MM_SHUFFLE(2, 1, 2, 0)) };
+    }
+
+    //lanes below count from a, the rest from b
+    static LaneVector selectFirst(int count, LaneVector a, LaneVector b) {
+        auto mask = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(firstLanesMasks[count])));
+        return { _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v)) };
+    }
+
+    float getLast() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+#elif SIMPLEEQ_LANES_NEON
+    float32x4_t v;
+
+    static LaneVector load(const float* p) { return { vld1q_f32(p) }; }
+    void store(float* p) const { vst1q_f32(p, v); }
+    static LaneVector broadcast(float x) { return { vdupq_n_f32(x) }; }
+
+    friend LaneVector operator+(LaneVector a, LaneVector b) { return { vaddq_f32(a.v, b.v) }; }
+    friend LaneVector operator-(LaneVector a, LaneVector b) { return { vsubq_f32(a.v, b.v) }; }
+    friend LaneVector operator*(LaneVector a, LaneVector b) { return { vmulq_f32(a.v, b.v) }; }
+
+    static LaneVector shiftUp(LaneVector v, LaneVector carry) { return { vextq_f32(carry.v, v.v, 3) }; }
+
+    static LaneVector selectFirst(int count, LaneVector a, LaneVector b) {
+        return { vbslq_f32(vld1q_u32(firstLanesMasks[count]), a.v, b.v) };
+    }
+
+    float getLast() const { return vgetq_lane_f32(v, 3); }
+#else
+    float v[size];
+
+    static LaneVector load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    void store(float* p) const { for (int l = 0; l < size; ++l) p[l] = v[l]; }
+    static LaneVector broadcast(float x) { return { { x, x, x, x } }; }
+
+    friend LaneVector operator+(LaneVector a, LaneVector b) { for (int l = 0; l < size; ++l) a.v[l] += b.v[l]; return a; }
+    friend LaneVector operator-(LaneVector a, LaneVector b) { for (int l = 0; l < size; ++l) a.v[l] -= b.v[l]; return a; }
+    friend LaneVector operator*(LaneVector a, LaneVector b) { for (int l = 0; l < size; ++l) a.v[l] *= b.v[l]; return a; }
+
+    static LaneVector shiftUp(LaneVector v, LaneVector carry) { return { { carry.v[3], v.v[0], v.v[1], v.v[2] } }; }
+
+    static LaneVector selectFirst(int count, LaneVector a, LaneVector b) {
+        for (int l = count; l < size; ++l) a.v[l] = b.v[l];
+        return a;
+    }
+
+    float getLast() const { return v[size - 1]; }
+#endif
+
+#if SIMPLEEQ_LANES_SSE || SIMPLEEQ_LANES_NEON
+    alignas(16) static constexpr uint32_t firstLanesMasks[size + 1][size] = {
+        { 0, 0, 0, 0 }, { ~0u, 0, 0, 0 }, { ~0u, ~0u, 0, 0 }, { ~0u, ~0u, ~0u, 0 }, { ~0u, ~0u, ~0u, ~0u }
+    };
+#endif
+};
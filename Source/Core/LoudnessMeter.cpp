@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double pi = 3.141592653589793238;
+constexpr float minusInfinity = -std::numeric_limits<float>::infinity();
+
+constexpr double histogramMin = -70.0, histogramStep = 0.1;
+
+//mean square energy at the centre of each histogram bin
+const auto binEnergies = [] {
+    std::array<double, 750> energies{}; //LoudnessMeter::histogramBins
+    for (size_t i = 0; i < energies.size(); ++i)
+        energies[i] = std::pow(10.0, (histogramMin + (double(i) + 0.5) * histogramStep + 0.691) / 10.0);
+    return energies;
+}();
+
+double energyToLoudness(double energy) {
+    return energy > 0 ? -0.691 + 10.0 * std::log10(energy) : double(minusInfinity);
+}
+
+}
+
+LoudnessMeter::LoudnessMeter() {
+    //blackman windowed sinc, 48 taps split into 4 phases
+    const int numTaps = oversampling * tapsPerPhase;
+    const double centre = (numTaps - 1) * 0.5;
+
+    for (int n = 0; n < numTaps; ++n) {
+        auto t = (n - centre) / oversampling;
+        auto sinc = t == 0 ? 1.0 : std::sin(pi * t) / (pi * t);
+        auto window = 0.42 - 0.5 * std::cos(2.0 * pi * n / (numTaps - 1)) + 0.08 * std::cos(4.0 * pi * n / (numTaps - 1));
+        interpolator[n % oversampling][n / oversampling] = float(sinc * window);
+    }
+
+    prepare(sampleRate, 2);
+}
+
+void LoudnessMeter::prepare(double newSampleRate, int newNumChannels) {
+    sampleRate = newSampleRate;
+    numChannels = std::clamp(newNumChannels, 0, maxChannels);
+
+    preFilter.setAllLanes(designKWeightingShelf(sampleRate));
+    rlbFilter.setAllLanes(designKWeightingHighPass(sampleRate));
+    stepLength = std::max(1, int(std::lround(sampleRate * 0.1)));
+
+    reset();
+}
+
+void LoudnessMeter::reset() {
+    preFilterState = {};
+    rlbFilterState = {};
+
+    std::fill(std::begin(stepEnergy), std::end(stepEnergy), 0.0);
+    stepPosition = 0;
+    historyPosition = 0;
+    historySize = 0;
+    std::fill(std::begin(histogram), std::end(histogram), 0u);
+
+    for (auto& frame : truePeakHistory)
+        std::fill(std::begin(frame), std::end(frame), 0.f);
+    truePeakPosition = 0;
+    truePeakLinear = 0;
+
+    momentary = minusInfinity;
+    shortTerm = minusInfinity;
+    integrated = minusInfinity;
+    truePeak = minusInfinity;
+}
+
+void LoudnessMeter::process(const float* const* channels, int numChannelsToProcess, int numSamples) {
+    auto channelsToProcess = std::min(numChannelsToProcess, numChannels);
+    auto peakAtStart = truePeakLinear;
+
+    for (int start = 0; start < numSamples; start += blockSize) {
+        auto length = std::min(blockSize, numSamples - start);
+
+        //lanes without a channel stay silent
+        alignas(16) float block[blockSize][lanes]{};
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+            for (int i = 0; i < length; ++i)
+                block[i][ch] = channels[ch][start + i];
+
+        for (int i = 0; i < length; ++i)
+            updateTruePeak(block[i]);
+
+        processLaneBiquad(preFilter, preFilterState, block, length);
+        processLaneBiquad(rlbFilter, rlbFilterState, block, length);
+
+        for (int i = 0; i < length; ++i) {
+            for (int l = 0; l < lanes; ++l)
+                stepEnergy[l] += double(block[i][l]) * block[i][l];
+
+            if (++stepPosition == stepLength)
+                finishStep();
+        }
+    }
+
+    //keep the filter state out of denormals, same as EQEngine
+    preFilterState.snapToZero();
+    rlbFilterState.snapToZero();
+
+    if (truePeakLinear != peakAtStart)
+        truePeak = float(20.0 * std::log10(double(truePeakLinear)));
+}
+
+void LoudnessMeter::updateTruePeak(const float* x) {
+    std::copy(x, x + lanes, truePeakHistory[truePeakPosition]);
+
+    for (int phase = 0; phase < oversampling; ++phase) {
+        alignas(16) float sum[lanes]{};
+
+        for (int t = 0; t < tapsPerPhase; ++t) {
+            const auto* frame = truePeakHistory[(truePeakPosition + tapsPerPhase - t) % tapsPerPhase];
+            auto h = interpolator[phase][t];
+
+            for (int l = 0; l < lanes; ++l)
+                sum[l] += h * frame[l];
+        }
+
+        for (int l = 0; l < lanes; ++l)
+            truePeakLinear = std::max(truePeakLinear, std::abs(sum[l]));
+    }
+
+    truePeakPosition = (truePeakPosition + 1) % tapsPerPhase;
+}
+
+//called every 100 ms of input
+void LoudnessMeter::finishStep() {
+    double energy = 0;
+    for (int l = 0; l < lanes; ++l) {
+        energy += stepEnergy[l]; //all channel weights are 1 for mono and stereo
+        stepEnergy[l] = 0;
+    }
+
+    stepHistory[historyPosition] = energy / stepLength;
+    historyPosition = (historyPosition + 1) % shortTermSteps;
+    historySize = std::min(historySize + 1, shortTermSteps);
+    stepPosition = 0;
+
+    auto meanOfLast = [this](int steps) {
+        double sum = 0;
+        for (int i = 1; i <= steps; ++i)
+            sum += stepHistory[(historyPosition + shortTermSteps - i) % shortTermSteps];
+        return sum / steps;
+    };
+
+    if (historySize >= momentarySteps) {
+        auto blockLoudness = energyToLoudness(meanOfLast(momentarySteps));
+        momentary = float(blockLoudness);
+
+        //400 ms gating blocks with 75 % overlap are exactly the momentary values
+        if (blockLoudness >= histogramMin) {
+            auto bin = std::min(int((blockLoudness - histogramMin) / histogramStep), histogramBins - 1);
+            ++histogram[bin];
+            updateIntegrated();
+        }
+    }
+
+    if (historySize == shortTermSteps)
+        shortTerm = float(energyToLoudness(meanOfLast(shortTermSteps)));
+}
+
+void LoudnessMeter::updateIntegrated() {
+    double energy = 0;
+    uint64_t count = 0;
+
+    for (int i = 0; i < histogramBins; ++i) {
+        energy += binEnergies[i] * histogram[i];
+        count += histogram[i];
+    }
+
+    if (count == 0)
+        return;
+
+    auto relativeGate = energyToLoudness(energy / double(count)) - 10.0;
+    auto firstBin = std::clamp(int(std::ceil((relativeGate - histogramMin) / histogramStep)), 0, histogramBins);
+
+    energy = 0;
+    count = 0;
+    for (int i = firstBin; i < histogramBins; ++i) {
+        energy += binEnergies[i] * histogram[i];
+        count += histogram[i];
+    }
+
+    integrated = count > 0 ? float(energyToLoudness(energy / double(count))) : minusInfinity;
+}
+
+LoudnessReadings LoudnessMeter::getReadings() const {
+    return { momentary.load(std::memory_order_relaxed), shortTerm.load(std::memory_order_relaxed),
+             integrated.load(std::memory_order_relaxed), truePeak.load(std::memory_order_relaxed) };
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+    ITU-R BS.1770 / EBU R128 loudness (momentary, short-term, integrated)
+    and 4x oversampled true peak.
+
+    K-weighting runs every channel through the same two biquads side by
+    side in SIMD lanes, on the same kernel as EQEngine (LaneBiquad.h). Gating history is fixed size: a ring of
+    100 ms energies for the sliding windows and a 0.1 LU histogram for the
+    integrated value, so process() never allocates. Readings are atomics
+    and can be read from any thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "LaneBiquad.h"
+
+#include <atomic>
+#include <cstdint>
+
+struct LoudnessReadings {
+    float momentary, shortTerm, integrated; //LUFS, -inf until there is enough signal
+    float truePeak;                         //dBTP, highest since reset
+};
+
+class LoudnessMeter
+{
+public:
+    static constexpr int maxChannels = LaneBiquadCoefficients::lanes; //one per SIMD lane
+
+    LoudnessMeter();
+
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    void process(const float* const* channels, int numChannels, int numSamples);
+
+    LoudnessReadings getReadings() const;
+
+private:
+    static constexpr int lanes = maxChannels;
+    static constexpr int shortTermSteps = 30; //3 s of 100 ms steps
+    static constexpr int momentarySteps = 4;  //400 ms
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int histogramBins = 750; //-70 to +5 LUFS in 0.1 LU
+    static constexpr int blockSize = 64;      //frames gathered into lanes at a time
+
+    void finishStep();
+    void updateTruePeak(const float* x);
+    void updateIntegrated();
+
+    double sampleRate{ 48000.0 };
+    int numChannels{ 0 };
+
+    LaneBiquadCoefficients preFilter, rlbFilter;
+    LaneBiquadState preFilterState, rlbFilterState;
+
+    alignas(16) double stepEnergy[lanes]{};
+    int stepLength{ 4800 }, stepPosition{ 0 };
+
+    double stepHistory[shortTermSteps]{};
+    int historyPosition{ 0 }, historySize{ 0 };
+
+    uint32_t histogram[histogramBins]{};
+
+    //polyphase interpolator for true peak, history per lane
+    float interpolator[oversampling][tapsPerPhase]{};
+    alignas(16) float truePeakHistory[tapsPerPhase][lanes]{};
+    int truePeakPosition{ 0 };
+    float truePeakLinear{ 0 };
+
+    std::atomic<float> momentary, shortTerm, integrated, truePeak;
+};
@@ -0,0 +1,314 @@
+/*
+  ==============================================================================
+
+    ResponseFit.cpp
+    Levenberg-Marquardt over log frequencies, gain and log Q, with a
+    numerical jacobian: a design and a magnitude sweep are cheap next to
+    getting the derivatives of a cascade right by hand.
+
+  ==============================================================================
+*/
+
+#include "ResponseFit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+//log2 low cut, log2 high cut, log2 peak frequency, peak gain in dB, log2 Q
+constexpr int numFitParameters = 5;
+
+constexpr double minFrequency = 20.0, maxFrequency = 20000.0;
+constexpr double lowerBounds[numFitParameters] = { 4.321928094887363, 4.321928094887363, 4.321928094887363, -24.0, -3.321928094887362 };
+constexpr double upperBounds[numFitParameters] = { 14.28771237954945, 14.28771237954945, 14.28771237954945, 24.0, 3.321928094887362 };
+
+//central difference steps: 1% in frequency and Q, 0.01 dB in gain
+constexpr double steps[numFitParameters] = { 0.0144, 0.0144, 0.0144, 0.01, 0.0144 };
+
+constexpr int maxIterations = 200;
+
+struct FitProblem {
+    std::vector<double> frequencies, target;
+    double sampleRate;
+    ChainSettings base;
+};
+
+ChainSettings toSettings(const double* p, Slope lowCutSlope, Slope highCutSlope, const ChainSettings& base) {
+    auto settings = base;
+    settings.lowCutFreq = float(std::exp2(p[0]));
+    settings.highCutFreq = float(std::exp2(p[1]));
+    settings.peakFreq = float(std::exp2(p[2]));
+    settings.peakGainInDecibels = float(p[3]);
+    settings.peakQuality = float(std::exp2(p[4]));
+    settings.lowCutSlope = lowCutSlope;
+    settings.highCutSlope = highCutSlope;
+    return settings;
+}
+
+//floors a curve in dB below its median and takes its mean out, so the level drops out of the fit.
+//target and chain both go through this, so a chain that matches up to a level matches exactly
+void floorAndCentre(std::vector<double>& levels, std::vector<double>& scratch) {
+    scratch = levels;
+    auto middle = scratch.begin() + std::ptrdiff_t(scratch.size() / 2);
+    std::nth_element(scratch.begin(), middle, scratch.end());
+    auto floor = *middle + fitFloorInDecibels;
+
+    double mean = 0;
+    for (auto& level : levels) {
+        level = std::max(level, floor);
+        mean += level;
+    }
+
+    mean /= double(levels.size());
+    for (auto& level : levels)
+        level -= mean;
+}
+
+void evaluate(const FitProblem& problem, const ChainSettings& settings, std::vector<double>& response) {
+    ChainCoefficients chain;
+    designChain(settings, problem.sampleRate, chain);
+
+    for (size_t i = 0; i < response.size(); ++i) {
+        auto magnitude = chain.getMagnitudeForFrequency(problem.frequencies[i], problem.sampleRate);
+        response[i] = 20.0 * std::log10(magnitude + 1.0e-30);
+    }
+
+    std::vector<double> scratch;
+    floorAndCentre(response, scratch);
+}
+
+double getCost(const FitProblem& problem, const std::vector<double>& response) {
+    double cost = 0;
+    for (size_t i = 0; i < response.size(); ++i)
+        cost += (problem.target[i] - response[i]) * (problem.target[i] - response[i]);
+
+    return cost;
+}
+
+//solves the 5x5 normal equations in place by gaussian elimination with partial pivoting
+bool solve(double (&m)[numFitParameters][numFitParameters], double (&v)[numFitParameters]) {
+    for (int col = 0; col < numFitParameters; ++col) {
+        auto pivot = col;
+        for (int row = col + 1; row < numFitParameters; ++row) {
+            if (std::abs(m[row][col]) > std::abs(m[pivot][col]))
+                pivot = row;
+        }
+
+        if (std::abs(m[pivot][col]) < 1.0e-300)
+            return false;
+
+        std::swap(m[col], m[pivot]);
+        std::swap(v[col], v[pivot]);
+
+        for (int row = col + 1; row < numFitParameters; ++row) {
+            auto factor = m[row][col] / m[col][col];
+            for (int k = col; k < numFitParameters; ++k)
+                m[row][k] -= factor * m[col][k];
+            v[row] -= factor * v[col];
+        }
+    }
+
+    for (int row = numFitParameters - 1; row >= 0; --row) {
+        for (int k = row + 1; k < numFitParameters; ++k)
+            v[row] -= m[row][k] * v[k];
+        v[row] /= m[row][row];
+    }
+
+    return true;
+}
+
+//levenberg-marquardt from p, kept inside the parameter ranges; returns the final cost
+double refine(const FitProblem& problem, Slope lowCutSlope, Slope highCutSlope, double* p) {
+    auto numPoints = problem.frequencies.size();
+    std::vector<double> response(numPoints), plus(numPoints), minus(numPoints);
+    std::vector<double> jacobian[numFitParameters];
+    for (auto& column : jacobian)
+        column.resize(numPoints);
+
+    evaluate(problem, toSettings(p, lowCutSlope, highCutSlope, problem.base), response);
+    auto cost = getCost(problem, response);
+    auto lambda = 1.0e-3;
+
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        for (int k = 0; k < numFitParameters; ++k) {
+            double q[numFitParameters];
+            std::copy(p, p + numFitParameters, q);
+
+            q[k] = std::min(p[k] + steps[k], upperBounds[k]);
+            auto high = q[k];
+            evaluate(problem, toSettings(q, lowCutSlope, highCutSlope, problem.base), plus);
+
+            q[k] = std::max(p[k] - steps[k], lowerBounds[k]);
+            auto low = q[k];
+            evaluate(problem, toSettings(q, lowCutSlope, highCutSlope, problem.base), minus);
+
+            for (size_t i = 0; i < numPoints; ++i)
+                jacobian[k][i] = (plus[i] - minus[i]) / (high - low);
+        }
+
+        double normal[numFitParameters][numFitParameters], gradient[numFitParameters];
+        for (int j = 0; j < numFitParameters; ++j) {
+            gradient[j] = 0;
+            for (size_t i = 0; i < numPoints; ++i)
+                gradient[j] += jacobian[j][i] * (problem.target[i] - response[i]);
+
+            for (int k = 0; k < numFitParameters; ++k) {
+                normal[j][k] = 0;
+                for (size_t i = 0; i < numPoints; ++i)
+                    normal[j][k] += jacobian[j][i] * jacobian[k][i];
+            }
+        }
+
+        //raise lambda until a step lowers the cost; give up once the steps stop mattering
+        auto improved = false;
+        while (! improved && lambda < 1.0e10) {
+            double m[numFitParameters][numFitParameters], delta[numFitParameters];
+            for (int j = 0; j < numFitParameters; ++j) {
+                std::copy(normal[j], normal[j] + numFitParameters, m[j]);
+                m[j][j] += lambda * (normal[j][j] + 1.0e-9);
+                delta[j] = gradient[j];
+            }
+
+            if (solve(m, delta)) {
+                double trial[numFitParameters];
+                for (int k = 0; k < numFitParameters; ++k)
+                    trial[k] = std::clamp(p[k] + delta[k], lowerBounds[k], upperBounds[k]);
+
+                evaluate(problem, toSettings(trial, lowCutSlope, highCutSlope, problem.base), plus);
+                auto trialCost = getCost(problem, plus);
+
+                if (trialCost < cost) {
+                    std::copy(trial, trial + numFitParameters, p);
+                    std::swap(response, plus);
+                    improved = cost - trialCost > cost * 1.0e-10;
+                    cost = trialCost;
+                    lambda = std::max(lambda * 0.3, 1.0e-9);
+
+                    if (! improved)
+                        return cost;
+
+                    break;
+                }
+            }
+
+            lambda *= 4.0;
+        }
+
+        if (! improved)
+            break;
+    }
+
+    return cost;
+}
+
+//where to start: cuts where the target falls more than 6 dB at the ends, the peak on the
+//largest deviation the cuts leave, an octave wide
+void getStartingPoint(const FitProblem& problem, Slope lowCutSlope, Slope highCutSlope, double* p) {
+    const auto& freqs = problem.frequencies;
+    const auto& target = problem.target;
+    auto numPoints = int(freqs.size());
+
+    //level from the middle of the band, like the ear would judge it
+    double mean = 0;
+    int meanCount = 0;
+    for (int i = 0; i < numPoints; ++i) {
+        if (freqs[i] >= 100.0 && freqs[i] <= 10000.0) {
+            mean += target[i];
+            ++meanCount;
+        }
+    }
+    mean = meanCount > 0 ? mean / meanCount : 0.0;
+
+    auto lowCut = minFrequency, highCut = maxFrequency;
+
+    if (target.front() - mean < -6.0) {
+        int i = 0;
+        while (i < numPoints - 1 && freqs[i] < 1000.0 && target[i] - mean < -3.0)
+            ++i;
+        lowCut = freqs[i];
+    }
+
+    if (target.back() - mean < -6.0) {
+        int i = numPoints - 1;
+        while (i > 0 && freqs[i] > 2000.0 && target[i] - mean < -3.0)
+            --i;
+        highCut = freqs[i];
+    }
+
+    p[0] = std::log2(lowCut);
+    p[1] = std::log2(highCut);
+    p[2] = std::log2(1000.0);
+    p[3] = 0.0;
+    p[4] = std::log2(1.41);
+
+    std::vector<double> response(freqs.size());
+    evaluate(problem, toSettings(p, lowCutSlope, highCutSlope, problem.base), response);
+
+    int best = -1;
+    double bestDeviation = 0;
+    for (int i = 0; i < numPoints; ++i) {
+        if (freqs[i] < lowCut * 1.5 || freqs[i] > highCut / 1.5)
+            continue;
+
+        auto deviation = target[i] - response[i];
+        if (best < 0 || std::abs(deviation) > std::abs(bestDeviation)) {
+            best = i;
+            bestDeviation = deviation;
+        }
+    }
+
+    if (best >= 0) {
+        p[2] = std::log2(freqs[best]);
+        p[3] = std::clamp(bestDeviation, -24.0, 24.0);
+    }
+}
+
+}
+
+ChainSettings fitChainToResponse(const double* frequencies, const double* targetInDecibels, int numPoints,
+                                 double sampleRate, const ChainSettings& current, double* rmsErrorInDecibels) {
+    FitProblem problem;
+    problem.sampleRate = sampleRate;
+    problem.base = current;
+
+    for (int i = 0; i < numPoints; ++i) {
+        if (frequencies[i] > 0.0 && frequencies[i] < sampleRate * 0.5) {
+            problem.frequencies.push_back(frequencies[i]);
+            problem.target.push_back(targetInDecibels[i]);
+        }
+    }
+
+    if (problem.frequencies.empty()) {
+        if (rmsErrorInDecibels != nullptr)
+            *rmsErrorInDecibels = 0.0;
+        return current;
+    }
+
+    std::vector<double> scratch;
+    floorAndCentre(problem.target, scratch);
+
+    ChainSettings best = current;
+    auto bestCost = -1.0;
+
+    for (int low = Slope_12; low <= Slope_48; ++low) {
+        for (int high = Slope_12; high <= Slope_48; ++high) {
+            auto lowCutSlope = static_cast<Slope>(low), highCutSlope = static_cast<Slope>(high);
+
+            double p[numFitParameters];
+            getStartingPoint(problem, lowCutSlope, highCutSlope, p);
+            auto cost = refine(problem, lowCutSlope, highCutSlope, p);
+
+            if (bestCost < 0 || cost < bestCost) {
+                bestCost = cost;
+                best = toSettings(p, lowCutSlope, highCutSlope, current);
+            }
+        }
+    }
+
+    if (rmsErrorInDecibels != nullptr)
+        *rmsErrorInDecibels = std::sqrt(bestCost / double(problem.target.size()));
+
+    return best;
+}
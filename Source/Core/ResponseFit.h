@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    ResponseFit.h
+    Least squares fit of the chain's low cut, peak and high cut to a target
+    response, for the match EQ or any batch job that has a curve to hit.
+    Plain C++, no JUCE dependency, so it can be built into SimpleEQCore.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "EQDesign.h"
+
+//minimises the rms difference in dB between the chain and target over the points, with the
+//overall level left free (the chain has no gain of its own). both sides are floored at
+//fitFloorInDecibels below the median level, so a deep cut doesn't outweigh the rest of the curve.
+//frequencies, cuts, peak gain and Q are fitted together for every pair of slopes and the best
+//pair is kept; the dynamic peak settings are taken from current. points at or above nyquist
+//are ignored. rmsErrorInDecibels, if given, gets the error of the returned settings
+constexpr double fitFloorInDecibels = -60.0;
+
+ChainSettings fitChainToResponse(const double* frequencies, const double* targetInDecibels, int numPoints,
+                                 double sampleRate, const ChainSettings& current,
+                                 double* rmsErrorInDecibels = nullptr);
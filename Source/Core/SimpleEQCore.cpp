@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    SimpleEQCore.cpp
+
+  ==============================================================================
+*/
+
+#include "SimpleEQCore.h"
+#include "EQEngine.h"
+
+#include <algorithm>
+
+namespace {
+
+EQEngine* toEngine(SimpleEQInstance* instance) {
+    return reinterpret_cast<EQEngine*>(instance);
+}
+
+Slope toSlope(int slope) {
+    return static_cast<Slope>(std::clamp(slope, int(Slope_12), int(Slope_48)));
+}
+
+}
+
+void simpleeq_default_params(SimpleEQParams* params) {
+    if (params == nullptr)
+        return;
+
+    ChainSettings defaults;
+
+    params->lowCutFreq = defaults.lowCutFreq;
+    params->lowCutSlope = defaults.lowCutSlope;
+    params->highCutFreq = defaults.highCutFreq;
+    params->highCutSlope = defaults.highCutSlope;
+    params->peakFreq = defaults.peakFreq;
+    params->peakGainInDecibels = defaults.peakGainInDecibels;
+    params->peakQuality = defaults.peakQuality;
+
+    params->peakDynamic = defaults.peakDynamic ? 1 : 0;
+    params->peakSidechain = defaults.peakSidechain ? 1 : 0;
+    params->peakThreshold = defaults.peakThreshold;
+    params->peakRatio = defaults.peakRatio;
+    params->peakAttack = defaults.peakAttack;
+    params->peakRelease = defaults.peakRelease;
+}
+
+size_t simpleeq_memory_size(int maxChannels) {
+    return EQEngine::getRequiredMemorySize(maxChannels);
+}
+
+size_t simpleeq_memory_alignment(void) {
+    return EQEngine::memoryAlignment;
+}
+
+SimpleEQInstance* simpleeq_create(void* memory, size_t memorySize, int maxChannels) {
+    return reinterpret_cast<SimpleEQInstance*>(EQEngine::create(memory, memorySize, maxChannels));
+}
+
+int simpleeq_prepare(SimpleEQInstance* instance, double sampleRate, int maxBlockSize, int numChannels) {
+    if (instance == nullptr)
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    return toEngine(instance)->prepare(sampleRate, maxBlockSize, numChannels) ? SIMPLEEQ_OK
+                                                                            : SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+}
+
+int simpleeq_set_params(SimpleEQInstance* instance, const SimpleEQParams* params) {
+    return simpleeq_set_params_for_set(instance, 0, params);
+}
+
+int simpleeq_set_stereo_mode(SimpleEQInstance* instance, int stereoMode) {
+    if (instance == nullptr || stereoMode < SIMPLEEQ_STEREO_LINKED || stereoMode > SIMPLEEQ_STEREO_MID_SIDE)
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    toEngine(instance)->setStereoMode(static_cast<StereoMode>(stereoMode));
+
+    return SIMPLEEQ_OK;
+}
+
+int simpleeq_set_params_for_set(SimpleEQInstance* instance, int parameterSet, const SimpleEQParams* params) {
+    if (instance == nullptr || params == nullptr || parameterSet < 0 || parameterSet >= numParameterSets)
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    ChainSettings settings;
+
+    settings.lowCutFreq = std::clamp(params->lowCutFreq, 20.f, 20000.f);
+    settings.lowCutSlope = toSlope(params->lowCutSlope);
+    settings.highCutFreq = std::clamp(params->highCutFreq, 20.f, 20000.f);
+    settings.highCutSlope = toSlope(params->highCutSlope);
+    settings.peakFreq = std::clamp(params->peakFreq, 20.f, 20000.f);
+    settings.peakGainInDecibels = std::clamp(params->peakGainInDecibels, -24.f, 24.f);
+    settings.peakQuality = std::clamp(params->peakQuality, 0.1f, 10.f);
+
+    settings.peakDynamic = params->peakDynamic != 0;
+    settings.peakSidechain = params->peakSidechain != 0;
+    settings.peakThreshold = std::clamp(params->peakThreshold, -60.f, 0.f);
+    settings.peakRatio = std::clamp(params->peakRatio, 1.f, 20.f);
+    settings.peakAttack = std::clamp(params->peakAttack, 0.1f, 100.f);
+    settings.peakRelease = std::clamp(params->peakRelease, 5.f, 1000.f);
+
+    toEngine(instance)->setParameters(settings, parameterSet);
+
+    return SIMPLEEQ_OK;
+}
+
+int simpleeq_reset(SimpleEQInstance* instance) {
+    if (instance == nullptr)
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    toEngine(instance)->reset();
+
+    return SIMPLEEQ_OK;
+}
+
+int simpleeq_set_auto_gain(SimpleEQInstance* instance, int autoGain) {
+    if (instance == nullptr || autoGain < SIMPLEEQ_AUTO_GAIN_OFF || autoGain > SIMPLEEQ_AUTO_GAIN_K_WEIGHTED)
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    toEngine(instance)->setAutoGain(autoGain != SIMPLEEQ_AUTO_GAIN_OFF,
+                                    autoGain == SIMPLEEQ_AUTO_GAIN_PINK ? Weighting_Pink : Weighting_K);
+
+    return SIMPLEEQ_OK;
+}
+
+int simpleeq_set_output_gain(SimpleEQInstance* instance, float gainInDecibels) {
+    if (instance == nullptr || !(gainInDecibels >= -24.f && gainInDecibels <= 24.f))
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    toEngine(instance)->setOutputGain(gainInDecibels);
+
+    return SIMPLEEQ_OK;
+}
+
+int simpleeq_process_interleaved(SimpleEQInstance* instance, float* samples, int numFrames) {
+    if (instance == nullptr || (samples == nullptr && numFrames > 0) || numFrames < 0)
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    auto* engine = toEngine(instance);
+    if (engine->getSampleRate() <= 0)
+        return SIMPLEEQ_ERROR_NOT_PREPARED;
+
+    engine->processInterleaved(samples, numFrames);
+
+    return SIMPLEEQ_OK;
+}
+
+int simpleeq_process_planar(SimpleEQInstance* instance, float* const* channels, int numChannels, int numFrames) {
+    return simpleeq_process_planar_sidechain(instance, channels, numChannels, nullptr, 0, numFrames);
+}
+
+int simpleeq_process_planar_sidechain(SimpleEQInstance* instance, float* const* channels, int numChannels,
+                                      const float* const* sidechain, int numSidechainChannels, int numFrames) {
+    if (instance == nullptr || channels == nullptr || numChannels < 0 || numFrames < 0 || numSidechainChannels < 0)
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    auto* engine = toEngine(instance);
+    if (engine->getSampleRate() <= 0)
+        return SIMPLEEQ_ERROR_NOT_PREPARED;
+
+    if (numChannels > engine->getNumChannels())
+        return SIMPLEEQ_ERROR_INVALID_ARGUMENT;
+
+    engine->processPlanar(channels, numChannels, numFrames, sidechain, sidechain != nullptr ? numSidechainChannels : 0);
+
+    return SIMPLEEQ_OK;
+}
+
+void simpleeq_destroy(SimpleEQInstance* instance) {
+    if (instance != nullptr)
+        toEngine(instance)->~EQEngine();
+}
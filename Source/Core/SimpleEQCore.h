@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    SimpleEQCore.h
+    C API for embedding the SimpleEQ filter chain without a plugin host.
+
+    The caller owns all memory: ask simpleeq_memory_size() for the size of
+    an instance, hand a block aligned to simpleeq_memory_alignment() to
+    simpleeq_create(), and free it yourself after simpleeq_destroy().
+    Nothing is allocated by the library, so every call is safe on a
+    real-time thread once simpleeq_prepare() has returned.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SimpleEQInstance SimpleEQInstance;
+
+enum {
+    SIMPLEEQ_OK = 0,
+    SIMPLEEQ_ERROR_INVALID_ARGUMENT = -1,
+    SIMPLEEQ_ERROR_NOT_PREPARED = -2
+};
+
+enum {
+    SIMPLEEQ_SLOPE_12 = 0,
+    SIMPLEEQ_SLOPE_24,
+    SIMPLEEQ_SLOPE_36,
+    SIMPLEEQ_SLOPE_48
+};
+
+enum {
+    SIMPLEEQ_STEREO_LINKED = 0,
+    SIMPLEEQ_STEREO_DUAL_MONO,
+    SIMPLEEQ_STEREO_MID_SIDE
+};
+
+enum {
+    SIMPLEEQ_AUTO_GAIN_OFF = 0,
+    SIMPLEEQ_AUTO_GAIN_PINK,
+    SIMPLEEQ_AUTO_GAIN_K_WEIGHTED
+};
+
+/* same ranges as the plugin parameters */
+typedef struct SimpleEQParams {
+    float lowCutFreq;         /* 20 - 20000 Hz */
+    int   lowCutSlope;        /* SIMPLEEQ_SLOPE_* */
+    float highCutFreq;        /* 20 - 20000 Hz */
+    int   highCutSlope;       /* SIMPLEEQ_SLOPE_* */
+    float peakFreq;           /* 20 - 20000 Hz */
+    float peakGainInDecibels; /* -24 - 24 dB */
+    float peakQuality;        /* 0.1 - 10 */
+
+    /* dynamic peak: above the threshold the band's gain is pulled down like a compressor.
+       with peakSidechain the detector listens to the sidechain given to
+       simpleeq_process_planar_sidechain() instead of the main signal */
+    int   peakDynamic;        /* 0 or 1 */
+    int   peakSidechain;      /* 0 or 1 */
+    float peakThreshold;      /* -60 - 0 dB */
+    float peakRatio;          /* 1 - 20 */
+    float peakAttack;         /* 0.1 - 100 ms */
+    float peakRelease;        /* 5 - 1000 ms */
+} SimpleEQParams;
+
+void simpleeq_default_params(SimpleEQParams* params);
+
+size_t simpleeq_memory_size(int maxChannels);
+size_t simpleeq_memory_alignment(void);
+
+/* returns NULL if memory is NULL, misaligned or smaller than simpleeq_memory_size() */
+SimpleEQInstance* simpleeq_create(void* memory, size_t memorySize, int maxChannels);
+
+int simpleeq_prepare(SimpleEQInstance* instance, double sampleRate, int maxBlockSize, int numChannels);
+int simpleeq_set_params(SimpleEQInstance* instance, const SimpleEQParams* params);
+
+/* dual mono and mid/side pair up channels 0 and 1, 2 and 3, ...: set 0 runs left or mid,
+   set 1 right or side. simpleeq_set_params() sets 0, linked runs everything on it */
+int simpleeq_set_stereo_mode(SimpleEQInstance* instance, int stereoMode);
+int simpleeq_set_params_for_set(SimpleEQInstance* instance, int parameterSet, const SimpleEQParams* params);
+int simpleeq_reset(SimpleEQInstance* instance);
+
+/* auto gain undoes the chain's loudness change for pink or K-weighted noise, worked out
+   from the coefficients; the output gain (-24 - 24 dB) goes on top. both ramp over 50 ms */
+int simpleeq_set_auto_gain(SimpleEQInstance* instance, int autoGain);
+int simpleeq_set_output_gain(SimpleEQInstance* instance, float gainInDecibels);
+
+/* in place; interleaved uses the channel count given to simpleeq_prepare() */
+int simpleeq_process_interleaved(SimpleEQInstance* instance, float* samples, int numFrames);
+int simpleeq_process_planar(SimpleEQInstance* instance, float* const* channels, int numChannels, int numFrames);
+
+/* as simpleeq_process_planar(); a set with peakSidechain on detects from these channels, paired
+   up like the main ones (one channel feeds both sets). NULL or no channels detects from the main signal */
+int simpleeq_process_planar_sidechain(SimpleEQInstance* instance, float* const* channels, int numChannels,
+                                      const float* const* sidechain, int numSidechainChannels, int numFrames);
+
+/* the memory block can be released once this returns */
+void simpleeq_destroy(SimpleEQInstance* instance);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    SnapshotSlot.h
+    One stored ChainDesign (an A/B slot) shared between a writer (the
+    message thread storing it) and a reader (the audio thread running it)
+    without locks. The reader marks the entry it holds, the writer fills an
+    entry that is neither current nor held and then swaps the pointer, so a
+    switch on the audio side is one atomic load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "EQDesign.h"
+
+#include <atomic>
+
+class SnapshotSlot
+{
+public:
+    //writer side
+    void store(const ChainDesign& design) {
+        auto* entry = entries;
+        while (entry == current.load() || entry == inUse.load())
+            ++entry;
+
+        *entry = design;
+        current.store(entry);
+    }
+
+    //reader side; the pointer stays valid until the next call, nullptr while nothing is stored
+    const ChainDesign* acquire() {
+        auto* entry = current.load();
+        inUse.store(entry);
+
+        //the writer may have refilled this entry before it saw it held, take the newer one
+        while (current.load() != entry) {
+            entry = current.load();
+            inUse.store(entry);
+        }
+
+        return entry;
+    }
+
+    bool isEmpty() const { return current.load() == nullptr; }
+
+private:
+    ChainDesign entries[3];
+    std::atomic<ChainDesign*> current{ nullptr }, inUse{ nullptr };
+};
@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "EngineHolder.h"
+
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr int numRuns = 20;
+    constexpr int morphControlInterval = 64; //the processor's
+
+    volatile float designSink; //keeps the timed designs from being optimised away
+
+    //processes as many channels as the buffer has
+    double getMicrosecondsPerBlock(EQEngine& engine, const juce::AudioBuffer<float>& noise)
+    {
+        double best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            juce::AudioBuffer<float> buffer(noise);
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i + blockSize <= buffer.getNumSamples(); i += blockSize)
+            {
+                float* channels[numChannels] = {};
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    channels[ch] = buffer.getWritePointer(ch, i);
+
+                engine.processPlanar(channels, buffer.getNumChannels(), blockSize);
+            }
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            best = juce::jmin(best, seconds * 1.0e6 * blockSize / buffer.getNumSamples());
+        }
+
+        return best;
+    }
+
+    double getMicrosecondsPerBlock(const ChainSettings& settings, const juce::AudioBuffer<float>& noise)
+    {
+        EngineHolder engine(numChannels, settings, sampleRate, blockSize);
+        return getMicrosecondsPerBlock(*engine, noise);
+    }
+
+    //best of numRuns, nanoseconds per call of design(i)
+    template <typename Design>
+    double getNanosecondsPerDesign(Design&& design)
+    {
+        constexpr int numDesigns = 10000;
+        double best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numDesigns; ++i)
+                design(i);
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            best = juce::jmin(best, seconds * 1.0e9 / numDesigns);
+        }
+
+        return best;
+    }
+
+    //what the coefficient design costs where it runs at control rate: a morph step (interpolating
+    //and designing the whole chain, every 64 samples) and the dynamic peak's gain update (every 32),
+    //each against processing as many stereo samples. this is all a faster, approximated design
+    //could win back
+    void benchmarkDesign(double microsecondsPerBlock)
+    {
+        ChainSettings from, to;
+        to.lowCutFreq = 200.f;
+        to.lowCutSlope = Slope_48;
+        to.highCutFreq = 8000.f;
+        to.highCutSlope = Slope_48;
+        to.peakFreq = 3000.f;
+        to.peakGainInDecibels = -9.f;
+        to.peakQuality = 3.f;
+
+        auto morphStep = getNanosecondsPerDesign([&](int i) {
+            ChainDesign design;
+            designChain(interpolateSettings(from, to, float(i % 1024) / 1023.f), sampleRate, design);
+            designSink = design.coefficients.sections[0].b0;
+        });
+
+        auto dynamicPeak = designDynamicPeak(to, sampleRate);
+        auto gainUpdate = getNanosecondsPerDesign([&](int i) {
+            designSink = makeDynamicPeak(dynamicPeak, -0.5f * float(i % 32)).b0;
+        });
+
+        auto nanosecondsPerSample = microsecondsPerBlock * 1000.0 / blockSize;
+
+        std::cout << "morph step " << juce::String(morphStep, 1) << " ns, "
+                  << juce::String(100.0 * morphStep / (morphControlInterval * nanosecondsPerSample), 1) << "% of processing "
+                  << morphControlInterval << " samples; "
+                  << "dynamic gain update " << juce::String(gainUpdate, 1) << " ns, "
+                  << juce::String(100.0 * gainUpdate / (EQEngine::dynamicControlInterval * nanosecondsPerSample), 1)
+                  << "% of processing " << EQEngine::dynamicControlInterval << " samples\n";
+    }
+
+    //mono through the wavefront against the lane kernel, where the cuts are steep and the rate high
+    void benchmarkWavefront(const juce::AudioBuffer<float>& noise)
+    {
+        juce::AudioBuffer<float> mono(1, noise.getNumSamples());
+        mono.copyFrom(0, 0, noise, 0, 0, noise.getNumSamples());
+
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.highCutFreq = 12000.f;
+        settings.lowCutSlope = Slope_48;
+        settings.highCutSlope = Slope_48;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakThreshold = -30.f;
+
+        for (auto dynamic : { false, true })
+            for (auto rate : { 96000.0, 192000.0, 384000.0 })
+            {
+                settings.peakDynamic = dynamic;
+                double microseconds[2];
+
+                for (auto wavefront : { true, false })
+                {
+                    EngineHolder engine(1, settings, rate, blockSize);
+                    engine->setWavefrontEnabled(wavefront);
+                    microseconds[wavefront ? 0 : 1] = getMicrosecondsPerBlock(*engine, mono);
+                }
+
+                std::cout << "mono, " << (dynamic ? "dynamic " : "static ") << rate / 1000.0 << " kHz, 48 dB/oct cuts: wavefront "
+                          << microseconds[0] << " us, lanes " << microseconds[1] << " us per block, "
+                          << juce::String(microseconds[1] / microseconds[0], 2) << "x\n";
+            }
+    }
+}
+
+void runBenchmarks()
+{
+    juce::AudioBuffer<float> noise(numChannels, int(sampleRate) * 2);
+    juce::Random random(0x5eed);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < noise.getNumSamples(); ++i)
+            noise.setSample(ch, i, (random.nextFloat() * 2.f - 1.f) * 0.5f);
+
+    //default cuts, +6 dB peak; the threshold is low enough that the band is always moving
+    ChainSettings settings;
+    settings.peakGainInDecibels = 6.f;
+    settings.peakThreshold = -30.f;
+
+    auto staticTime = getMicrosecondsPerBlock(settings, noise);
+    settings.peakDynamic = true;
+    auto dynamicTime = getMicrosecondsPerBlock(settings, noise);
+
+    std::cout << "stereo, " << blockSize << " samples, " << sampleRate / 1000.0 << " kHz: static peak "
+              << staticTime << " us, dynamic peak " << dynamicTime << " us per block, "
+              << juce::String(dynamicTime / staticTime, 2) << "x\n";
+
+    benchmarkWavefront(noise);
+    benchmarkDesign(staticTime);
+}
@@ -0,0 +1,21 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    Times the engine on the cases the commit messages quote, so the numbers
+    can be reproduced: the dynamic peak against the static one (stereo,
+    48 kHz), and a mono channel through the wavefront against the lane
+    kernel with 48 dB/oct cuts at 96 to 384 kHz, static and dynamic. 512
+    sample blocks, best of 20 runs over two seconds of noise. Then the
+    coefficient design where it runs at control rate, a morph step and a
+    dynamic gain update, as a share of processing the samples in between.
+    Run with SimpleEQHostSim --benchmark.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+void runBenchmarks();
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    EngineHolder.h
+    An EQEngine in its own aligned memory, the way the processor holds one,
+    for the checks that drive the engine directly.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Core/EQEngine.h"
+
+struct EngineHolder
+{
+    EngineHolder(int numChannels, const ChainSettings& settings, double sampleRate, int maxBlockSize)
+    {
+        auto size = EQEngine::getRequiredMemorySize(numChannels);
+        memory.allocate(size + EQEngine::memoryAlignment, true);
+        engine = EQEngine::create(juce::snapPointerToAlignment(memory.get(), EQEngine::memoryAlignment), size, numChannels);
+
+        engine->setParameters(settings);
+        engine->prepare(sampleRate, maxBlockSize, numChannels);
+    }
+
+    EQEngine* operator->() const { return engine; }
+    EQEngine& operator*() const { return *engine; }
+
+    juce::HeapBlock<char> memory;
+    EQEngine* engine{ nullptr };
+};
@@ -0,0 +1,296 @@
+/*
+  ==============================================================================
+
+    GainCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "GainCheck.h"
+#include "EngineHolder.h"
+
+#include <iostream>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int sliceLength = 64; //the processor's morph control interval
+
+    constexpr double maxCompensationErrorInDecibels = 0.1;
+    constexpr double maxSettledErrorInDecibels = 0.001;
+    constexpr double maxRampError = 1.0e-5; //relative, float rounding of the ramp and of the ratio it's measured by
+    constexpr double maxMorphLagInDecibels = 0.1;
+
+    const int rampLength = (int) std::lround(sampleRate * EQEngine::gainRampSeconds);
+
+    ChainSettings makeSettings(float peakGain, float lowCutFreq = 20.f, Slope lowCutSlope = Slope_12,
+                               float highCutFreq = 20000.f, Slope highCutSlope = Slope_12)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = lowCutFreq;
+        settings.lowCutSlope = lowCutSlope;
+        settings.peakFreq = 1000.f;
+        settings.peakGainInDecibels = peakGain;
+        settings.peakQuality = 1.f;
+        settings.highCutFreq = highCutFreq;
+        settings.highCutSlope = highCutSlope;
+        return settings;
+    }
+
+    //the opposite of the loudness change, integrated on a 1/48 octave grid straight from the
+    //magnitude responses instead of the engine's 1/6 octave power polynomials
+    double getExpectedCompensation(const ChainSettings& settings, LoudnessWeighting weighting)
+    {
+        ChainCoefficients chain;
+        designChain(settings, sampleRate, chain);
+
+        auto shelf = designKWeightingShelf(sampleRate);
+        auto highPass = designKWeightingHighPass(sampleRate);
+
+        double power = 0, weights = 0;
+
+        for (double f = 20.0; f <= juce::jmin(20000.0, sampleRate * 0.49); f *= std::pow(2.0, 1.0 / 48.0))
+        {
+            auto weight = weighting == Weighting_K
+                        ? juce::square(shelf.getMagnitudeForFrequency(f, sampleRate) * highPass.getMagnitudeForFrequency(f, sampleRate))
+                        : 1.0;
+
+            power += weight * juce::square(chain.getMagnitudeForFrequency(f, sampleRate));
+            weights += weight;
+        }
+
+        return -10.0 * std::log10(power / weights);
+    }
+
+    //the engine under test and a twin with neither auto nor output gain, given the same settings and
+    //the same 1 kHz sine. gain comes last in the chain, so wherever the twin is loud enough to divide
+    //by, the ratio of the two is the gain that was applied
+    class GainProbe
+    {
+    public:
+        GainProbe(int numChannels, const ChainSettings& settings)
+            : measured(numChannels, settings, sampleRate, sliceLength),
+              plain(numChannels, settings, sampleRate, sliceLength),
+              numChannels(numChannels)
+        {
+        }
+
+        EQEngine* operator->() const { return measured.engine; }
+
+        void setParameters(const ChainSettings& settings, int parameterSet = 0)
+        {
+            measured->setParameters(settings, parameterSet);
+            plain->setParameters(settings, parameterSet);
+        }
+
+        void setStereoMode(StereoMode mode)
+        {
+            measured->setStereoMode(mode);
+            plain->setStereoMode(mode);
+        }
+
+        //one slice; onGain(sample, channel, gain) for every loud enough sample, counted from the start
+        template <typename Callback>
+        void process(Callback&& onGain)
+        {
+            float output[maxChannels][sliceLength], reference[maxChannels][sliceLength];
+            float* outputChannels[maxChannels];
+            float* referenceChannels[maxChannels];
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                for (int i = 0; i < sliceLength; ++i)
+                    output[ch][i] = reference[ch][i]
+                        = 0.5f * (float) std::sin(juce::MathConstants<double>::twoPi * 1000.0 * (position + i) / sampleRate);
+
+                outputChannels[ch] = output[ch];
+                referenceChannels[ch] = reference[ch];
+            }
+
+            measured->processPlanar(outputChannels, numChannels, sliceLength);
+            plain->processPlanar(referenceChannels, numChannels, sliceLength);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < sliceLength; ++i)
+                    if (std::abs(reference[ch][i]) > 0.1f)
+                        onGain(position + i, ch, double(output[ch][i]) / double(reference[ch][i]));
+
+            position += sliceLength;
+        }
+
+        int getPosition() const { return position; }
+
+    private:
+        static constexpr int maxChannels = 2;
+
+        EngineHolder measured, plain;
+        int numChannels, position{ 0 };
+    };
+
+    juce::String describe(const ChainSettings& s)
+    {
+        return "low cut " + juce::String(s.lowCutFreq, 1) + " Hz/" + juce::String(12 * (s.lowCutSlope + 1))
+             + ", peak " + juce::String(s.peakFreq, 1) + " Hz " + juce::String(s.peakGainInDecibels, 1) + " dB"
+             + ", high cut " + juce::String(s.highCutFreq, 1) + " Hz/" + juce::String(12 * (s.highCutSlope + 1));
+    }
+
+    //every set's compensation, and the gain the engine settles on with output gain on top
+    juce::Result checkCompensation()
+    {
+        auto boost = makeSettings(12.f), dip = makeSettings(-12.f);
+        std::vector<ChainSettings> cases = { makeSettings(0.f), boost, dip, makeSettings(6.f, 200.f, Slope_48, 5000.f, Slope_24) };
+
+        for (auto weighting : { Weighting_Pink, Weighting_K })
+            for (const auto& settings : cases)
+            {
+                EngineHolder engine(1, settings, sampleRate, sliceLength);
+
+                if (engine->getCompensationInDecibels() != 0.f)
+                    return juce::Result::fail("compensation while auto gain is off, " + describe(settings));
+
+                engine->setAutoGain(true, weighting);
+
+                auto compensation = engine->getCompensationInDecibels();
+                auto expected = getExpectedCompensation(settings, weighting);
+
+                std::cout << (weighting == Weighting_K ? "K-weighted " : "pink ") << describe(settings) << ": compensation "
+                          << juce::String(compensation, 3) << " dB, integrated " << juce::String(expected, 3) << " dB\n";
+
+                if (std::abs(compensation - expected) > maxCompensationErrorInDecibels)
+                    return juce::Result::fail("compensation off for " + describe(settings));
+            }
+
+        //dual mono compensates each set by its own chain, and the output gain goes on top of both
+        GainProbe probe(2, boost);
+        probe.setParameters(dip, 1);
+        probe.setStereoMode(Stereo_DualMono);
+        probe->setAutoGain(true, Weighting_K);
+        probe->setOutputGain(6.f);
+
+        double expected[] = { getExpectedCompensation(boost, Weighting_K), getExpectedCompensation(dip, Weighting_K) };
+        double settled[] = { 0.0, 0.0 };
+
+        for (int ch = 0; ch < 2; ++ch)
+            if (std::abs(probe->getCompensationInDecibels(ch) - expected[ch]) > maxCompensationErrorInDecibels)
+                return juce::Result::fail("dual mono set " + juce::String(ch) + " compensation off");
+
+        while (probe.getPosition() < 4 * rampLength)
+            probe.process([&settled](int, int ch, double gain) { settled[ch] = juce::Decibels::gainToDecibels(gain); });
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            auto target = 6.0 + probe->getCompensationInDecibels(ch);
+            std::cout << "dual mono set " << ch << " with 6 dB output gain: settled at " << juce::String(settled[ch], 3)
+                      << " dB, expected " << juce::String(target, 3) << " dB\n";
+
+            if (std::abs(settled[ch] - target) > maxSettledErrorInDecibels)
+                return juce::Result::fail("dual mono set " + juce::String(ch) + " settled at the wrong gain");
+        }
+
+        return juce::Result::ok();
+    }
+
+    //output gain ramps linearly from where it is; a new value half way steers the ramp over what's
+    //left of it. mono runs the wavefront, stereo the lanes
+    juce::Result checkOutputGainRamp()
+    {
+        for (int numChannels = 1; numChannels <= 2; ++numChannels)
+        {
+            GainProbe probe(numChannels, makeSettings(0.f));
+
+            for (int i = 0; i < 4; ++i)
+                probe.process([](int, int, double) {});
+
+            auto start = probe.getPosition();
+            auto target = std::pow(10.f, 6.f * 0.05f);
+            probe->setOutputGain(6.f);
+
+            //the second change comes at the first slice past half way
+            auto change = start + (rampLength / 2 + sliceLength - 1) / sliceLength * sliceLength;
+            auto atChange = 1.0 + (target - 1.0) * (change - start) / rampLength;
+            double worst = 0;
+            int worstSample = 0;
+
+            while (probe.getPosition() < start + 2 * rampLength)
+            {
+                if (probe.getPosition() == change)
+                    probe->setOutputGain(0.f);
+
+                probe.process([&](int sample, int, double gain) {
+                    auto expected = sample < change ? 1.0 + (target - 1.0) * (sample - start) / rampLength
+                                  : sample < start + rampLength ? atChange + (1.0 - atChange) * (sample - change) / (start + rampLength - change)
+                                  : 1.0;
+
+                    auto error = std::abs(gain / expected - 1.0);
+                    if (error > worst)
+                    {
+                        worst = error;
+                        worstSample = sample - start;
+                    }
+                });
+            }
+
+            std::cout << (numChannels == 1 ? "mono" : "stereo") << " output gain ramp: worst relative error " << worst
+                      << " at sample " << worstSample << " of the ramp\n";
+
+            if (worst > maxRampError)
+                return juce::Result::fail("output gain doesn't ramp linearly");
+        }
+
+        return juce::Result::ok();
+    }
+
+    //a second long morph from flat to +12 dB at 1 kHz, moved every slice like processMorphed does
+    juce::Result checkMorph()
+    {
+        auto from = makeSettings(0.f), to = makeSettings(12.f);
+        auto morphLength = juce::roundToInt(sampleRate);
+
+        GainProbe probe(1, from);
+        probe->setAutoGain(true, Weighting_K);
+
+        double worstLag = 0, worstSettled = 0;
+
+        while (probe.getPosition() < morphLength + rampLength)
+        {
+            auto start = probe.getPosition();
+            auto amount = juce::jmin(1.f, float(start + sliceLength) / float(morphLength));
+            probe.setParameters(interpolateSettings(from, to, amount));
+
+            auto target = (double) probe->getCompensationInDecibels();
+
+            probe.process([&](int sample, int, double gain) {
+                auto error = std::abs(juce::Decibels::gainToDecibels(gain) - target);
+
+                if (sample < morphLength)
+                    worstLag = juce::jmax(worstLag, error);
+                else if (sample >= morphLength + rampLength / 4)
+                    worstSettled = juce::jmax(worstSettled, error);
+            });
+        }
+
+        std::cout << "morph: worst lag " << juce::String(worstLag, 3) << " dB behind the compensation, "
+                  << juce::String(worstSettled, 4) << " dB a quarter ramp after the end, compensation "
+                  << juce::String(probe->getCompensationInDecibels(), 3) << " dB\n";
+
+        if (worstLag > maxMorphLagInDecibels)
+            return juce::Result::fail("auto gain falls behind during a morph");
+
+        if (worstSettled > maxSettledErrorInDecibels)
+            return juce::Result::fail("auto gain doesn't settle after a morph");
+
+        return juce::Result::ok();
+    }
+}
+
+juce::Result checkGain()
+{
+    for (auto check : { checkCompensation, checkOutputGainRamp, checkMorph })
+    {
+        auto result = check();
+        if (result.failed())
+            return result;
+    }
+
+    return juce::Result::ok();
+}
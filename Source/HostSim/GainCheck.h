@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    GainCheck.h
+    Checks the engine's gain stage. Auto gain has to compensate each set by
+    the loudness change integrated straight from the chain's magnitude
+    response, within 0.1 dB (+12 dB at 1 kHz comes to about -3.7 dB
+    K-weighted). Output gain has to ramp linearly over gainRampSeconds, and
+    one changed mid-ramp has to carry on from where the gain is. Through a
+    morph moved every 64 samples, as processMorphed does, the gain has to
+    stay within 0.1 dB of the compensation and settle within a quarter
+    ramp of the end.
+    Run with SimpleEQHostSim --check-gain.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//fails on the first gain out of tolerance
+juce::Result checkGain();
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    HostTrace.cpp
+
+  ==============================================================================
+*/
+
+#include "HostTrace.h"
+
+namespace
+{
+    juce::Result parseTextTrace(const juce::File& file, std::vector<HostEvent>& events)
+    {
+        juce::StringArray lines;
+        file.readLines(lines);
+
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            auto text = lines[i].upToFirstOccurrenceOf("#", false, false).trim();
+            if (text.isEmpty())
+                continue;
+
+            auto tokens = juce::StringArray::fromTokens(text, true);
+            auto error = [&](const juce::String& message) {
+                return juce::Result::fail(file.getFileName() + ":" + juce::String(i + 1) + ": " + message);
+            };
+
+            HostEvent event{ HostEvent::Block, i + 1 };
+
+            if (tokens[0] == "prepare" && tokens.size() == 3)
+            {
+                event.type = HostEvent::Prepare;
+                event.sampleRate = tokens[1].getDoubleValue();
+                event.numSamples = tokens[2].getIntValue();
+
+                if (event.sampleRate <= 0 || event.numSamples <= 0)
+                    return error("prepare needs a sample rate and a block size");
+            }
+            else if (tokens[0] == "block" && (tokens.size() == 2 || tokens.size() == 3))
+            {
+                event.numSamples = tokens[1].getIntValue();
+                auto count = tokens.size() == 3 ? tokens[2].getIntValue() : 1;
+
+                if (event.numSamples < 0 || count <= 0)
+                    return error("bad block size or count");
+
+                events.insert(events.end(), size_t(count), event);
+                continue;
+            }
+            else if (tokens[0] == "param" && tokens.size() == 3)
+            {
+                event.type = HostEvent::Param;
+                event.parameterID = tokens[1];
+                event.value = tokens[2].getFloatValue();
+            }
+            else if (tokens[0] == "state" && tokens.size() <= 2)
+            {
+                event.type = HostEvent::State;
+                if (tokens.size() == 2)
+                {
+                    event.stateFile = file.getParentDirectory().getChildFile(tokens[1].unquoted());
+
+                    if (!event.stateFile.existsAsFile())
+                        return error("can't find " + event.stateFile.getFullPathName());
+                }
+            }
+            else
+            {
+                return error("don't know \"" + text + "\"");
+            }
+
+            events.push_back(event);
+        }
+
+        return juce::Result::ok();
+    }
+
+    juce::Result parseChromeTrace(const juce::File& file, std::vector<HostEvent>& events)
+    {
+        auto json = juce::JSON::parse(file);
+        auto* traceEvents = json.isArray() ? json.getArray() : json["traceEvents"].getArray();
+
+        if (traceEvents == nullptr)
+            return juce::Result::fail(file.getFileName() + " isn't a Chrome trace");
+
+        //each thread's buffer is written separately, put them back in time order
+        juce::Array<juce::var> sorted(*traceEvents);
+        std::stable_sort(sorted.begin(), sorted.end(), [](const juce::var& a, const juce::var& b) {
+            return double(a["ts"]) < double(b["ts"]);
+        });
+
+        juce::var instance;
+
+        for (int i = 0; i < sorted.size(); ++i)
+        {
+            const auto& e = sorted.getReference(i);
+            auto name = e["name"].toString();
+            auto args = e["args"];
+
+            if (name != "processBlock" && name != "prepareToPlay" && name != "setStateInformation")
+                continue;
+
+            if (instance.isVoid())
+                instance = args["instance"];
+            else if (args["instance"] != instance)
+                continue;
+
+            HostEvent event{ HostEvent::Block, i + 1 };
+            event.numSamples = args["blockSize"];
+
+            if (name == "prepareToPlay")
+            {
+                event.type = HostEvent::Prepare;
+                event.sampleRate = args["sampleRate"];
+            }
+            else if (name == "setStateInformation")
+            {
+                event.type = HostEvent::State;
+            }
+
+            events.push_back(event);
+        }
+
+        //tracing may have started after the host prepared, use what the first block ran at
+        if (!events.empty() && events.front().type != HostEvent::Prepare)
+        {
+            HostEvent prepare{ HostEvent::Prepare, 0 };
+            prepare.sampleRate = sorted.getReference(events.front().line - 1)["args"]["sampleRate"];
+
+            for (const auto& event : events)
+                prepare.numSamples = juce::jmax(prepare.numSamples, event.numSamples);
+
+            events.insert(events.begin(), prepare);
+        }
+
+        return juce::Result::ok();
+    }
+}
+
+juce::Result loadHostTrace(const juce::File& file, std::vector<HostEvent>& events)
+{
+    events.clear();
+
+    if (!file.existsAsFile())
+        return juce::Result::fail("can't find " + file.getFullPathName());
+
+    auto result = file.hasFileExtension("json") ? parseChromeTrace(file, events) : parseTextTrace(file, events);
+
+    if (result.wasOk() && (events.empty() || events.front().type != HostEvent::Prepare))
+        return juce::Result::fail(file.getFileName() + " has to start with a prepare");
+
+    return result;
+}
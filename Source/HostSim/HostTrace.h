@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    HostTrace.h
+    What a host did to the plugin, in order: prepares, blocks, parameter
+    changes and state loads. SimpleEQHostSim replays it.
+
+    Text traces have one event per line, '#' starts a comment:
+
+        prepare <sampleRate> <maxBlockSize>
+        block <numSamples> [count]
+        param <parameterID> <value>      value in the parameter's own units
+        state                            reload the current state
+        state <file>                     load a getStateInformation() dump
+
+    A .json file is read as a Chrome trace written with
+    SIMPLEEQ_ENABLE_TRACING: processBlock, prepareToPlay and
+    setStateInformation of the first instance in it become block, prepare
+    and state events. It has no parameter values, those need a text trace.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct HostEvent
+{
+    enum Type { Prepare, Block, Param, State };
+
+    Type type;
+    int line;                  //where it came from, so a spike can be found again
+    double sampleRate{ 0 };    //Prepare
+    int numSamples{ 0 };       //Prepare: max block size, Block: block size
+    juce::String parameterID;  //Param
+    float value{ 0 };          //Param
+    juce::File stateFile;      //State, reloads the current state when it doesn't exist
+};
+
+juce::Result loadHostTrace(const juce::File& file, std::vector<HostEvent>& events);
@@ -0,0 +1,880 @@
+/*
+  ==============================================================================
+
+    KernelCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "KernelCheck.h"
+#include "EngineHolder.h"
+#include "../PluginProcessor.h"
+
+#include <complex>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <type_traits>
+
+namespace
+{
+    constexpr double sampleRates[] = { 44100.0, 96000.0, 192000.0 };
+
+    //the ends of every band range and a few points between
+    struct BandPoint
+    {
+        float lowCutFreq, highCutFreq, peakFreq, peakGain, peakQuality;
+    };
+
+    constexpr BandPoint bandPoints[] = {
+        { 20.f, 20000.f, 750.f, 0.f, 1.f },
+        { 100.f, 8000.f, 1000.f, 12.f, 0.7f },
+        { 500.f, 2000.f, 200.f, -24.f, 10.f },
+        { 20.f, 20000.f, 20.f, 24.f, 0.1f },
+        { 40.f, 15000.f, 20000.f, -12.f, 4.f }
+    };
+
+    constexpr int blockSize = 512;
+    constexpr int stimulusLength = 16384;
+    constexpr double impulseSeconds = 2.0;
+
+    //the golden file keeps the start of every case's output, both channels, one case after another
+    constexpr int goldenLength = 256;
+    constexpr float goldenTolerance = 1.0e-6f;
+
+    constexpr double maxMagnitudeErrorInDecibels = 0.05;
+    //fewer checked points than this means the resolution estimate stopped telling noise from errors
+    constexpr double minMagnitudeCoverage = 0.7;
+
+    //the output gain change the gain paths make, between two blocks
+    constexpr float outputGainInDecibels = 6.f;
+    constexpr int outputGainChange = 8 * blockSize;
+
+    constexpr double minusInfinity = -std::numeric_limits<double>::infinity();
+
+    //settings drives set 0, otherSettings set 1 in dual mono and mid/side
+    struct TestCase
+    {
+        ChainSettings settings, otherSettings;
+        double sampleRate;
+
+        juce::String describe() const
+        {
+            return juce::String(settings.lowCutFreq) + " Hz " + juce::String(12 * (settings.lowCutSlope + 1)) + " dB/oct low cut, "
+                 + juce::String(settings.highCutFreq) + " Hz " + juce::String(12 * (settings.highCutSlope + 1)) + " dB/oct high cut, "
+                 + "peak " + juce::String(settings.peakFreq) + " Hz " + juce::String(settings.peakGainInDecibels) + " dB Q "
+                 + juce::String(settings.peakQuality) + ", " + juce::String(sampleRate) + " Hz";
+        }
+    };
+
+    std::vector<TestCase> getTestCases()
+    {
+        std::vector<TestCase> cases;
+
+        for (auto sampleRate : sampleRates)
+            for (int low = Slope_12; low <= Slope_48; ++low)
+                for (int high = Slope_12; high <= Slope_48; ++high)
+                    for (const auto& point : bandPoints)
+                    {
+                        TestCase testCase;
+                        testCase.sampleRate = sampleRate;
+
+                        auto& settings = testCase.settings;
+                        settings.lowCutSlope = static_cast<Slope>(low);
+                        settings.highCutSlope = static_cast<Slope>(high);
+                        settings.lowCutFreq = point.lowCutFreq;
+                        settings.highCutFreq = point.highCutFreq;
+                        settings.peakFreq = point.peakFreq;
+                        settings.peakGainInDecibels = point.peakGain;
+                        settings.peakQuality = point.peakQuality;
+
+                        cases.push_back(testCase);
+                    }
+
+        return cases;
+    }
+
+    //far enough from settings that a path mixing the sets up can't pass: the slopes swap ends,
+    //the peak moves an octave and flips its gain, Q doubles, the threshold drops 12 dB
+    ChainSettings getOtherSettings(const ChainSettings& settings)
+    {
+        auto other = settings;
+        other.lowCutSlope = settings.highCutSlope;
+        other.highCutSlope = settings.lowCutSlope;
+        other.peakFreq = settings.peakFreq < 10000.f ? settings.peakFreq * 2.f : settings.peakFreq * 0.5f;
+        other.peakGainInDecibels = -settings.peakGainInDecibels;
+        other.peakQuality = juce::jmin(settings.peakQuality * 2.f, 10.f);
+        other.peakThreshold = settings.peakThreshold - 12.f;
+        return other;
+    }
+
+    //what a path does on top of the static chain; the reference works each out its own way
+    enum Feature
+    {
+        Feature_None = 0,
+        Feature_DynamicPeak,    //the peak follows its own input
+        Feature_Sidechain,      //the peak follows makeSidechain()
+        Feature_OutputGain      //output gain goes to outputGainInDecibels at outputGainChange
+    };
+
+    //the sweep and the noise both cross the threshold, and attack and release are short enough
+    //that the band moves within every block
+    TestCase withFeature(TestCase testCase, Feature feature)
+    {
+        if (feature == Feature_DynamicPeak || feature == Feature_Sidechain)
+        {
+            auto& settings = testCase.settings;
+            settings.peakDynamic = true;
+            settings.peakSidechain = feature == Feature_Sidechain;
+            settings.peakThreshold = -30.f;
+            settings.peakRatio = 4.f;
+            settings.peakAttack = 1.f;
+            settings.peakRelease = 50.f;
+
+            testCase.otherSettings = getOtherSettings(settings);
+        }
+
+        return testCase;
+    }
+
+    //left is a log sweep from 20 Hz to 0.45 fs and right is seeded noise, so mid and side differ.
+    //the noise comes from the standard library, so the golden file doesn't depend on the JUCE version
+    juce::AudioBuffer<float> makeStimulus(double sampleRate)
+    {
+        juce::AudioBuffer<float> stimulus(2, stimulusLength);
+        std::minstd_rand random(0x5eed);
+
+        auto duration = stimulusLength / sampleRate;
+        auto startFrequency = 20.0, octaves = std::log2(0.45 * sampleRate / startFrequency);
+        auto rate = octaves / duration;
+
+        for (int i = 0; i < stimulusLength; ++i)
+        {
+            auto t = i / sampleRate;
+            auto phase = juce::MathConstants<double>::twoPi * startFrequency * (std::exp2(rate * t) - 1.0) / (rate * std::log(2.0));
+            auto noise = double(random() - random.min()) / double(random.max() - random.min());
+
+            stimulus.setSample(0, i, 0.5f * (float) std::sin(phase));
+            stimulus.setSample(1, i, ((float) noise * 2.f - 1.f) * 0.5f);
+        }
+
+        return stimulus;
+    }
+
+    //the stimulus the other way round and 6 dB louder, so the band hears something else than it filters
+    juce::AudioBuffer<float> makeSidechain(const juce::AudioBuffer<float>& stimulus)
+    {
+        juce::AudioBuffer<float> sidechain(2, stimulus.getNumSamples());
+
+        for (int ch = 0; ch < 2; ++ch)
+            sidechain.copyFrom(ch, 0, stimulus.getReadPointer(1 - ch), stimulus.getNumSamples(), 2.f);
+
+        return sidechain;
+    }
+
+    //SimpleEQAudioProcessor::processBlock as a host drives it, fresh from prepareToPlay for every render
+    class HostedProcessor
+    {
+    public:
+        //the settings go through the parameters, so they come back snapped to what a host can set
+        ChainSettings setCase(const TestCase& testCase)
+        {
+            applyChainSettings(testCase.settings, processor.apvts);
+            return getChainSettings(processor.apvts);
+        }
+
+        void render(const TestCase& testCase, juce::AudioBuffer<float>& stereo)
+        {
+            processor.setRateAndBufferSizeDetails(testCase.sampleRate, blockSize);
+            processor.prepareToPlay(testCase.sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer(juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels()), blockSize);
+            juce::MidiBuffer midi;
+
+            for (int start = 0; start < stereo.getNumSamples(); start += blockSize)
+            {
+                auto length = juce::jmin(blockSize, stereo.getNumSamples() - start);
+                juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), length);
+
+                block.clear();
+                for (int ch = 0; ch < stereo.getNumChannels(); ++ch)
+                    block.copyFrom(ch, 0, stereo, ch, start, length);
+
+                processor.processBlock(block, midi);
+
+                for (int ch = 0; ch < stereo.getNumChannels(); ++ch)
+                    stereo.copyFrom(ch, start, block, ch, 0, length);
+            }
+        }
+
+    private:
+        SimpleEQAudioProcessor processor;
+    };
+
+    //the reference: each channel through the designed sections one after another, written out the
+    //plain way and sharing nothing with EQEngine but the design functions. float is the reference
+    //itself, double the yardstick its rounding is measured against. set 0 runs left or mid, set 1
+    //right or side; linked runs set 0 on both. returns the channels one after another
+    template <typename Sample>
+    std::vector<Sample> renderCascade(const TestCase& testCase, StereoMode mode, Feature feature, const juce::AudioBuffer<float>& input)
+    {
+        auto numSamples = input.getNumSamples();
+        std::vector<Sample> output(2 * size_t(numSamples));
+        auto at = [&output, numSamples](int ch, int i) -> Sample& { return output[size_t(ch) * size_t(numSamples) + size_t(i)]; };
+
+        const ChainSettings* settings[] = { &testCase.settings, mode == Stereo_Linked ? &testCase.settings : &testCase.otherSettings };
+        ChainCoefficients sets[2];
+        DynamicPeakDesign dynamicPeaks[2];
+
+        for (int set = 0; set < 2; ++set)
+        {
+            designChain(*settings[set], testCase.sampleRate, sets[set]);
+            dynamicPeaks[set] = designDynamicPeak(*settings[set], testCase.sampleRate);
+        }
+
+        auto midSide = mode == Stereo_MidSide;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            Sample left = input.getSample(0, i), right = input.getSample(1, i);
+
+            at(0, i) = midSide ? Sample(0.5) * (left + right) : left;
+            at(1, i) = midSide ? Sample(0.5) * (left - right) : right;
+        }
+
+        auto sidechain = makeSidechain(input);
+        auto dynamic = feature == Feature_DynamicPeak || feature == Feature_Sidechain;
+
+        Sample state[2][numChainSections][2]{};
+        Sample detector[2][2]{}, envelope[2]{};
+        BiquadCoefficients peaks[2] = { sets[0].sections[getSectionIndex(Peak)], sets[1].sections[getSectionIndex(Peak)] };
+
+        auto runSection = [&](int ch, const BiquadCoefficients& c, Sample* s, int start, int length) {
+            for (int i = start; i < start + length; ++i)
+            {
+                Sample x = at(ch, i);
+                Sample y = c.b0 * x + s[0];
+                s[0] = c.b1 * x - c.a1 * y + s[1];
+                s[1] = c.b2 * x - c.a2 * y;
+                at(ch, i) = y;
+            }
+        };
+
+        //the band pass at the peak, then a one pole follower from the envelope the set had at
+        //the start of the slice; returns where the envelope got to
+        auto follow = [&](int set, Sample* s, int start, int length, auto getInput) {
+            const auto& d = dynamicPeaks[set];
+            auto env = envelope[set];
+
+            for (int i = start; i < start + length; ++i)
+            {
+                Sample x = getInput(i);
+                Sample y = d.detector.b0 * x + s[0];
+                s[0] = d.detector.b1 * x - d.detector.a1 * y + s[1];
+                s[1] = d.detector.b2 * x - d.detector.a2 * y;
+
+                Sample level = std::abs(y);
+                env = level + (level > env ? d.attackCoefficient : d.releaseCoefficient) * (env - level);
+            }
+
+            return env;
+        };
+
+        //the band moves once per control interval, so everything goes a slice at a time
+        for (int start = 0; start < numSamples; start += EQEngine::dynamicControlInterval)
+        {
+            auto length = juce::jmin(EQEngine::dynamicControlInterval, numSamples - start);
+            auto section = 0;
+
+            for (; section < getSectionIndex(Peak); ++section)
+                for (int ch = 0; ch < 2; ++ch)
+                    if (sets[ch].isActive(section))
+                        runSection(ch, sets[ch].sections[section], state[ch][section], start, length);
+
+            for (int set = 0; dynamic && set < (mode == Stereo_Linked ? 1 : 2); ++set)
+            {
+                //linked, the louder channel drives the band; otherwise each set hears its own channel
+                Sample loudest = 0;
+
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    if (mode != Stereo_Linked && ch != set)
+                        continue;
+
+                    Sample env;
+                    if (feature == Feature_DynamicPeak)
+                        env = follow(set, detector[ch], start, length, [&](int i) { return at(ch, i); });
+                    else if (midSide)
+                        env = follow(set, detector[ch], start, length, [&](int i) {
+                            Sample left = sidechain.getSample(0, i), right = sidechain.getSample(1, i);
+                            return set == 0 ? Sample(0.5) * (left + right) : Sample(0.5) * (left - right);
+                        });
+                    else
+                        env = follow(set, detector[ch], start, length, [&](int i) { return Sample(sidechain.getSample(ch, i)); });
+
+                    loudest = juce::jmax(loudest, env);
+                }
+
+                envelope[set] = loudest;
+
+                const auto& d = dynamicPeaks[set];
+                auto overshoot = juce::jmax(Sample(20) * std::log10(loudest + Sample(1.0e-9)) - Sample(d.threshold), Sample(0));
+                auto gain = juce::jlimit(Sample(-48), Sample(24), Sample(d.staticGainInDecibels) - overshoot * Sample(d.slope));
+                peaks[set] = makeDynamicPeak(d, float(gain));
+            }
+
+            for (int ch = 0; ch < 2; ++ch)
+                runSection(ch, peaks[mode == Stereo_Linked ? 0 : ch], state[ch][section], start, length);
+
+            for (++section; section < numChainSections; ++section)
+                for (int ch = 0; ch < 2; ++ch)
+                    if (sets[ch].isActive(section))
+                        runSection(ch, sets[ch].sections[section], state[ch][section], start, length);
+
+            //the engine flushes tiny state to zero after every call like juce::dsp::util::snapToZero,
+            //so the float reference does too at the end of every block the paths are fed
+            if (std::is_same<Sample, float>::value && (start + length) % blockSize == 0)
+            {
+                auto snap = [](Sample& value) { if (!(value < -1.0e-8f || value > 1.0e-8f)) value = 0; };
+
+                for (auto& channel : state)
+                    for (auto& sectionState : channel)
+                        for (auto& value : sectionState)
+                            snap(value);
+
+                for (auto& channel : detector)
+                    for (auto& value : channel)
+                        snap(value);
+
+                for (auto& value : envelope)
+                    snap(value);
+            }
+        }
+
+        //a linear ramp over gainRampSeconds from the change, worked out in double
+        if (feature == Feature_OutputGain)
+        {
+            auto target = std::pow(10.0, outputGainInDecibels / 20.0);
+            auto rampLength = double(std::lround(testCase.sampleRate * EQEngine::gainRampSeconds));
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = outputGainChange; i < numSamples; ++i)
+                    at(ch, i) *= Sample(1.0 + (target - 1.0) * juce::jmin(1.0, (i - outputGainChange) / rampLength));
+        }
+
+        if (midSide)
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto mid = at(0, i), side = at(1, i);
+                at(0, i) = mid + side;
+                at(1, i) = mid - side;
+            }
+
+        return output;
+    }
+
+    EngineHolder makeEngine(int numChannels, const TestCase& testCase)
+    {
+        return EngineHolder(numChannels, testCase.settings, testCase.sampleRate, blockSize);
+    }
+
+    //cycles through blockSizes until the buffer is done
+    void renderPlanar(EQEngine& engine, juce::AudioBuffer<float>& buffer, std::initializer_list<int> blockSizes = { blockSize },
+                      const juce::AudioBuffer<float>* sidechain = nullptr)
+    {
+        auto next = blockSizes.begin();
+
+        for (int start = 0; start < buffer.getNumSamples(); )
+        {
+            auto length = juce::jmin(*next, buffer.getNumSamples() - start);
+
+            float* channels[2];
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                channels[ch] = buffer.getWritePointer(ch, start);
+
+            const float* sidechainChannels[2] = {};
+            if (sidechain != nullptr)
+                for (int ch = 0; ch < 2; ++ch)
+                    sidechainChannels[ch] = sidechain->getReadPointer(ch, start);
+
+            engine.processPlanar(channels, buffer.getNumChannels(), length, sidechain != nullptr ? sidechainChannels : nullptr, 2);
+
+            start += length;
+            if (++next == blockSizes.end())
+                next = blockSizes.begin();
+        }
+    }
+
+    void renderMono(const TestCase& testCase, juce::AudioBuffer<float>& stereo, bool wavefront)
+    {
+        for (int ch = 0; ch < stereo.getNumChannels(); ++ch)
+        {
+            auto engine = makeEngine(1, testCase);
+            engine->setWavefrontEnabled(wavefront);
+
+            juce::AudioBuffer<float> channel(stereo.getArrayOfWritePointers() + ch, 1, stereo.getNumSamples());
+            renderPlanar(*engine, channel);
+        }
+    }
+
+    EngineHolder makeEngine(const TestCase& testCase, StereoMode mode)
+    {
+        auto engine = makeEngine(2, testCase);
+        engine->setParameters(testCase.otherSettings, 1);
+        engine->setStereoMode(mode);
+        return engine;
+    }
+
+    void renderBothSets(const TestCase& testCase, juce::AudioBuffer<float>& stereo, StereoMode mode, bool useSidechain = false)
+    {
+        auto sidechain = makeSidechain(stereo);
+        auto engine = makeEngine(testCase, mode);
+        renderPlanar(*engine, stereo, { blockSize }, useSidechain ? &sidechain : nullptr);
+    }
+
+    void renderOutputGainChange(const TestCase& testCase, juce::AudioBuffer<float>& stereo, StereoMode mode)
+    {
+        auto engine = makeEngine(testCase, mode);
+        juce::AudioBuffer<float> before(stereo.getArrayOfWritePointers(), 2, 0, outputGainChange);
+        juce::AudioBuffer<float> after(stereo.getArrayOfWritePointers(), 2, outputGainChange, stereo.getNumSamples() - outputGainChange);
+
+        renderPlanar(*engine, before);
+        engine->setOutputGain(outputGainInDecibels);
+        renderPlanar(*engine, after);
+    }
+
+    //how far a path may stray from the reference
+    enum Tolerance
+    {
+        Tolerance_Exact = 0,
+        Tolerance_OverRounding,   //its error against the double cascade at most maxError dB above the reference's own
+        Tolerance_Close           //its error against the reference at most maxError dB, for what the reference works out in double
+    };
+
+    struct Path
+    {
+        const char* name;
+        StereoMode mode;
+        Tolerance tolerance;
+        double maxErrorInDecibels;
+        std::function<void(const TestCase&, juce::AudioBuffer<float>&)> render;
+        Feature feature{ Feature_None };
+    };
+
+    //processBlock comes first, its output is what goes into the golden file
+    std::vector<Path> getPaths(HostedProcessor& processor)
+    {
+        return {
+            { "processBlock", Stereo_Linked, Tolerance_Exact, 0.0, [&processor](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                processor.render(testCase, stereo);
+            } },
+
+            { "engine, planar", Stereo_Linked, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                auto engine = makeEngine(2, testCase);
+                renderPlanar(*engine, stereo);
+            } },
+
+            { "engine, interleaved", Stereo_Linked, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                auto engine = makeEngine(2, testCase);
+                std::vector<float> frames(size_t(stereo.getNumSamples()) * 2);
+
+                for (int i = 0; i < stereo.getNumSamples(); ++i)
+                    for (int ch = 0; ch < 2; ++ch)
+                        frames[size_t(i) * 2 + size_t(ch)] = stereo.getSample(ch, i);
+
+                for (int start = 0; start < stereo.getNumSamples(); start += blockSize)
+                    engine->processInterleaved(frames.data() + size_t(start) * 2, juce::jmin(blockSize, stereo.getNumSamples() - start));
+
+                for (int i = 0; i < stereo.getNumSamples(); ++i)
+                    for (int ch = 0; ch < 2; ++ch)
+                        stereo.setSample(ch, i, frames[size_t(i) * 2 + size_t(ch)]);
+            } },
+
+            //tiny state is flushed at the ends of other blocks than the reference's, so it can't be exact
+            { "engine, uneven blocks", Stereo_Linked, Tolerance_OverRounding, 1.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                auto engine = makeEngine(2, testCase);
+                renderPlanar(*engine, stereo, { 1, 17, 64, 333, blockSize, 5 });
+            } },
+
+            { "mono, wavefront", Stereo_Linked, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderMono(testCase, stereo, true);
+            } },
+
+            { "mono, lane kernel", Stereo_Linked, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderMono(testCase, stereo, false);
+            } },
+
+            { "dual mono, different sets", Stereo_DualMono, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_DualMono);
+            } },
+
+            { "mid/side, different sets", Stereo_MidSide, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_MidSide);
+            } },
+
+            { "dynamic peak, linked", Stereo_Linked, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_Linked);
+            }, Feature_DynamicPeak },
+
+            { "dynamic peak, dual mono", Stereo_DualMono, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_DualMono);
+            }, Feature_DynamicPeak },
+
+            { "dynamic peak, mid/side", Stereo_MidSide, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_MidSide);
+            }, Feature_DynamicPeak },
+
+            { "sidechain, linked", Stereo_Linked, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_Linked, true);
+            }, Feature_Sidechain },
+
+            { "sidechain, dual mono", Stereo_DualMono, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_DualMono, true);
+            }, Feature_Sidechain },
+
+            { "sidechain, mid/side", Stereo_MidSide, Tolerance_Exact, 0.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderBothSets(testCase, stereo, Stereo_MidSide, true);
+            }, Feature_Sidechain },
+
+            //the engine steps the ramp in float, the reference works it out in double: a few ulps apart
+            { "output gain change, linked", Stereo_Linked, Tolerance_Close, -120.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderOutputGainChange(testCase, stereo, Stereo_Linked);
+            }, Feature_OutputGain },
+
+            { "output gain change, mid/side", Stereo_MidSide, Tolerance_Close, -120.0, [](const TestCase& testCase, juce::AudioBuffer<float>& stereo) {
+                renderOutputGainChange(testCase, stereo, Stereo_MidSide);
+            }, Feature_OutputGain }
+        };
+    }
+
+    //reads a buffer or renderCascade's channels one after another as double
+    auto readBuffer(const juce::AudioBuffer<float>& buffer)
+    {
+        return [&buffer](int ch, int i) { return double(buffer.getSample(ch, i)); };
+    }
+
+    template <typename Sample>
+    auto readCascade(const std::vector<Sample>& samples)
+    {
+        return [&samples](int ch, int i) { return double(samples[size_t(ch) * stimulusLength + size_t(i)]); };
+    }
+
+    //energy of the difference over the energy of the reference over the stimulus, in dB
+    template <typename Output, typename Reference>
+    double getErrorInDecibels(Output&& getOutput, Reference&& getReference)
+    {
+        double difference = 0, energy = 0;
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < stimulusLength; ++i)
+            {
+                double reference = getReference(ch, i);
+                difference += juce::square(getOutput(ch, i) - reference);
+                energy += juce::square(reference);
+            }
+
+        return difference > 0 ? 10.0 * std::log10(difference / energy) : minusInfinity;
+    }
+
+    bool isIdentical(const juce::AudioBuffer<float>& output, const std::vector<float>& reference)
+    {
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            if (std::memcmp(output.getReadPointer(ch), reference.data() + size_t(ch) * size_t(output.getNumSamples()),
+                            sizeof(float) * size_t(output.getNumSamples())) != 0)
+                return false;
+
+        return true;
+    }
+
+    //|sum of h[n] e^-jwn|; the phasor is recomputed every so often so it doesn't drift
+    template <typename Sample>
+    double getMeasuredMagnitude(const Sample* h, int numSamples, double frequency, double sampleRate)
+    {
+        auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        auto step = std::polar(1.0, -w);
+        std::complex<double> sum, z;
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            if (n % 1024 == 0)
+                z = std::polar(1.0, -w * n);
+
+            sum += double(h[n]) * z;
+            z *= step;
+        }
+
+        return std::abs(sum);
+    }
+
+    //float biquads lose precision as their poles close in on z = 1, far into the stop bands and
+    //at the bottom of the passband at high rates. the float reference's error against the double
+    //one at a frequency is what float can resolve there; where it takes up more than half the
+    //allowed error, a point says nothing about the design, so it isn't checked
+    bool isResolvable(double expected, double noise)
+    {
+        return noise <= 0.5 * (juce::Decibels::decibelsToGain(maxMagnitudeErrorInDecibels) - 1.0) * expected;
+    }
+
+    struct Worst
+    {
+        double value{ minusInfinity };
+        juce::String where;
+        bool failed{ false };
+
+        void update(double newValue, const juce::String& newWhere, bool fails)
+        {
+            if (fails && !failed)
+            {
+                failed = true;
+                value = newValue;
+                where = newWhere;
+            }
+            else if (newValue > value && (fails || !failed))
+            {
+                value = newValue;
+                where = newWhere;
+            }
+        }
+    };
+
+    //the worst magnitude error in dB wherever float can resolve it, counting the points that were
+    void checkMagnitude(const juce::AudioBuffer<float>& impulseResponse, const ChainCoefficients& coefficients,
+                        const TestCase& testCase, Worst& worst, int& numChecked, int& numPoints)
+    {
+        auto sampleRate = testCase.sampleRate;
+        auto length = impulseResponse.getNumSamples();
+
+        juce::AudioBuffer<float> impulse(2, length);
+        impulse.clear();
+        impulse.setSample(0, 0, 1.f);
+        impulse.setSample(1, 0, 1.f);
+
+        auto reference = renderCascade<float>(testCase, Stereo_Linked, Feature_None, impulse);
+        auto exact = renderCascade<double>(testCase, Stereo_Linked, Feature_None, impulse);
+
+        std::vector<double> rounding((size_t) length);
+        for (size_t i = 0; i < rounding.size(); ++i)
+            rounding[i] = double(reference[i]) - exact[i];
+
+        //third octaves from 20 Hz up to 0.45 fs
+        for (double f = 20.0; f < sampleRate * 0.45; f *= std::pow(2.0, 1.0 / 3.0))
+        {
+            ++numPoints;
+
+            auto expected = coefficients.getMagnitudeForFrequency(f, sampleRate);
+            if (!isResolvable(expected, getMeasuredMagnitude(rounding.data(), length, f, sampleRate)))
+                continue;
+
+            ++numChecked;
+
+            auto measured = getMeasuredMagnitude(impulseResponse.getReadPointer(0), length, f, sampleRate);
+            auto error = std::abs(juce::Decibels::gainToDecibels(measured / expected, -400.0));
+
+            worst.update(error, testCase.describe() + " at " + juce::String(f, 1) + " Hz", error > maxMagnitudeErrorInDecibels);
+        }
+    }
+
+    juce::Result writeGolden(const juce::File& file, const juce::AudioBuffer<float>& output)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+
+        if (stream == nullptr)
+            return juce::Result::fail("can't write " + file.getFullPathName());
+
+        //32 bit wav is float, so nothing is lost
+        std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(stream.get(), 48000.0,
+                                                                                               (unsigned int) output.getNumChannels(), 32, {}, 0));
+        if (writer == nullptr)
+            return juce::Result::fail("can't write " + file.getFullPathName());
+
+        stream.release();
+        writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+
+        std::cout << "wrote " << file.getFullPathName() << "\n";
+        return juce::Result::ok();
+    }
+
+    juce::Result compareGolden(const juce::File& file, const juce::AudioBuffer<float>& output, const std::vector<TestCase>& cases)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (reader == nullptr)
+            return juce::Result::fail("can't read " + file.getFullPathName());
+
+        if (reader->lengthInSamples != output.getNumSamples() || (int) reader->numChannels != output.getNumChannels())
+            return juce::Result::fail(file.getFullPathName() + " was rendered from other cases, rewrite it with --update-golden");
+
+        juce::AudioBuffer<float> golden(output.getNumChannels(), output.getNumSamples());
+        reader->read(&golden, 0, golden.getNumSamples(), 0, true, true);
+
+        float worst = 0;
+        int worstIndex = 0;
+
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            for (int i = 0; i < output.getNumSamples(); ++i)
+            {
+                auto difference = std::abs(output.getSample(ch, i) - golden.getSample(ch, i));
+                if (difference > worst)
+                {
+                    worst = difference;
+                    worstIndex = i;
+                }
+            }
+
+        std::cout << "golden output: worst difference " << worst << (worst > 0 ? " (" + cases[size_t(worstIndex / goldenLength)].describe() + ")" : juce::String()) << "\n";
+
+        if (worst > goldenTolerance)
+            return juce::Result::fail("output moved away from " + file.getFullPathName());
+
+        return juce::Result::ok();
+    }
+
+    juce::String describeDecibels(double decibels)
+    {
+        return decibels == minusInfinity ? juce::String("none") : juce::String(decibels, 1) + " dB";
+    }
+}
+
+juce::Result checkKernels(const juce::File& golden, bool updateGolden)
+{
+    HostedProcessor processor;
+    auto cases = getTestCases();
+    auto paths = getPaths(processor);
+
+    std::vector<Worst> pathErrors(paths.size());
+    Worst magnitude, rounding;
+    int numMagnitudesChecked = 0, numMagnitudes = 0;
+    juce::AudioBuffer<float> goldenOutput(2, int(cases.size()) * goldenLength);
+
+    std::map<double, juce::AudioBuffer<float>> stimuli;
+    for (auto sampleRate : sampleRates)
+        stimuli[sampleRate] = makeStimulus(sampleRate);
+
+    for (size_t c = 0; c < cases.size(); ++c)
+    {
+        auto testCase = cases[c];
+        testCase.settings = processor.setCase(testCase);
+        testCase.otherSettings = getOtherSettings(testCase.settings);
+        auto where = testCase.describe();
+
+        ChainCoefficients coefficients;
+        designChain(testCase.settings, testCase.sampleRate, coefficients);
+
+        juce::AudioBuffer<float> impulseResponse(2, juce::roundToInt(impulseSeconds * testCase.sampleRate));
+        impulseResponse.clear();
+        impulseResponse.setSample(0, 0, 1.f);
+        impulseResponse.setSample(1, 0, 1.f);
+
+        processor.render(testCase, impulseResponse);
+        checkMagnitude(impulseResponse, coefficients, testCase, magnitude, numMagnitudesChecked, numMagnitudes);
+
+        const auto& stimulus = stimuli[testCase.sampleRate];
+        std::map<std::pair<StereoMode, Feature>, std::vector<float>> references;
+        std::map<StereoMode, std::vector<double>> exact;
+        std::map<StereoMode, double> referenceRounding;
+
+        for (auto mode : { Stereo_Linked, Stereo_DualMono, Stereo_MidSide })
+        {
+            const auto& reference = references[{ mode, Feature_None }] = renderCascade<float>(testCase, mode, Feature_None, stimulus);
+            exact[mode] = renderCascade<double>(testCase, mode, Feature_None, stimulus);
+            referenceRounding[mode] = getErrorInDecibels(readCascade(reference), readCascade(exact[mode]));
+            rounding.update(referenceRounding[mode], where, false);
+        }
+
+        for (size_t p = 0; p < paths.size(); ++p)
+        {
+            const auto& path = paths[p];
+            auto pathCase = withFeature(testCase, path.feature);
+
+            auto& reference = references[{ path.mode, path.feature }];
+            if (reference.empty())
+                reference = renderCascade<float>(pathCase, path.mode, path.feature, stimulus);
+
+            juce::AudioBuffer<float> output(stimulus);
+            path.render(pathCase, output);
+
+            switch (path.tolerance)
+            {
+                case Tolerance_Exact:
+                {
+                    auto error = getErrorInDecibels(readBuffer(output), readCascade(reference));
+                    pathErrors[p].update(error, where, !isIdentical(output, reference));
+                    break;
+                }
+
+                case Tolerance_Close:
+                {
+                    auto error = getErrorInDecibels(readBuffer(output), readCascade(reference));
+                    pathErrors[p].update(error, where, error > path.maxErrorInDecibels);
+                    break;
+                }
+
+                case Tolerance_OverRounding:
+                {
+                    auto excess = getErrorInDecibels(readBuffer(output), readCascade(exact[path.mode])) - referenceRounding[path.mode];
+                    pathErrors[p].update(excess, where, excess > path.maxErrorInDecibels);
+                    break;
+                }
+            }
+
+            if (p == 0)
+                for (int ch = 0; ch < 2; ++ch)
+                    goldenOutput.copyFrom(ch, int(c) * goldenLength, output, ch, 0, goldenLength);
+        }
+    }
+
+    std::cout << cases.size() << " cases\n"
+              << "reference against a double precision cascade: worst " << describeDecibels(rounding.value)
+              << " (" << rounding.where << ")\n"
+              << "impulse response against getMagnitudeForFrequency: worst " << juce::String(magnitude.value, 3)
+              << " dB of " << juce::String(maxMagnitudeErrorInDecibels, 2) << " allowed (" << magnitude.where << "), "
+              << numMagnitudesChecked << " of " << numMagnitudes << " points within float resolution\n";
+
+    juce::StringArray failures;
+    if (magnitude.failed)
+        failures.add("impulse response doesn't match getMagnitudeForFrequency");
+
+    if (numMagnitudesChecked < minMagnitudeCoverage * numMagnitudes)
+        failures.add("too few points within float resolution to check the magnitude, at least "
+                     + juce::String(juce::roundToInt(minMagnitudeCoverage * 100)) + "% have to be");
+
+    for (size_t p = 0; p < paths.size(); ++p)
+    {
+        const auto& path = paths[p];
+        const auto& error = pathErrors[p];
+
+        std::cout << path.name << ": ";
+
+        if (path.tolerance == Tolerance_Exact)
+            std::cout << (error.failed ? "differs, by " + describeDecibels(error.value) + " (" + error.where + ")" : juce::String("identical"));
+        else if (path.tolerance == Tolerance_Close)
+            std::cout << "worst " << describeDecibels(error.value) << " from the reference, allowed "
+                      << juce::String(path.maxErrorInDecibels, 1) << " dB (" << error.where << ")";
+        else
+            std::cout << "worst " << juce::String(error.value, 1) << " dB over the reference's rounding, allowed "
+                      << juce::String(path.maxErrorInDecibels, 1) << " dB (" << error.where << ")";
+
+        std::cout << "\n";
+
+        if (error.failed)
+            failures.add(juce::String(path.name) + " is out of tolerance");
+    }
+
+    //the golden file is reviewed and committed like the code, so a missing one is an error, not written
+    auto result = updateGolden ? writeGolden(golden, goldenOutput)
+                : golden.existsAsFile() ? compareGolden(golden, goldenOutput, cases)
+                : juce::Result::fail(golden.getFullPathName() + " doesn't exist, render it with --update-golden");
+    if (result.failed())
+        failures.add(result.getErrorMessage());
+
+    if (!failures.isEmpty())
+        return juce::Result::fail(failures.joinIntoString("\n"));
+
+    return juce::Result::ok();
+}
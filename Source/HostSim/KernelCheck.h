@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    KernelCheck.h
+    Golden-output and kernel-equivalence checks for the processing paths.
+
+    Every case (each Slope pair, the ends and middle of the band parameter
+    ranges, 44.1 to 192 kHz) renders an impulse, a log sweep and noise. The
+    reference is a plain scalar float cascade of the sections designChain
+    gives, with its own mid/side encoding, detector and gain ramp, so it
+    shares no processing code with EQEngine; a double cascade measures its
+    rounding. Then:
+
+    - processBlock's impulse response has to match getMagnitudeForFrequency
+      within 0.05 dB wherever float biquads can resolve the frequency, that
+      is where the float reference's own error against the double one takes
+      up no more than half of that. At least 70% of the points have to be
+    - every way of running the chain (processBlock, engine planar or
+      interleaved, uneven blocks, mono wavefront and lanes, dual mono and
+      mid/side with different settings on the two sets, the dynamic peak
+      following its input or a sidechain in each stereo mode, an output
+      gain change) has to match the reference within its own tolerance;
+      all but uneven blocks and the gain ramp, which the reference works
+      out in double, exactly
+    - processBlock has to match what was rendered into the golden file,
+      by default the committed Source/HostSim/KernelGolden.wav
+
+    Run with SimpleEQHostSim --check-kernels [--golden=<file.wav>] [--update-golden]
+    from the repository root, or point --golden at the file from elsewhere.
+    A missing golden file fails the check; --update-golden rewrites it after
+    a change that is meant to move the output, to be reviewed with the change.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//prints the worst error of every path, fails when any is out of tolerance
+juce::Result checkKernels(const juce::File& golden, bool updateGolden);
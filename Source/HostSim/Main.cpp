@@ -0,0 +1,635 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    SimpleEQHostSim: replays a HostTrace into a SimpleEQAudioProcessor with
+    no host, audio device or editor, and reports block latency plus any
+    allocation or lock taken on the audio thread.
+
+    Everything runs on one thread in trace order, so a run is repeatable:
+    state loads and prepares happen between blocks exactly where the trace
+    puts them. The input is seeded noise.
+
+        SimpleEQHostSim <trace> [--runs=N]
+        SimpleEQHostSim --check-wavefront
+        SimpleEQHostSim --check-kernels [--golden=<file.wav>] [--update-golden]
+        SimpleEQHostSim --check-allocations
+        SimpleEQHostSim --check-match-eq
+        SimpleEQHostSim --check-snapshots
+        SimpleEQHostSim --check-gain
+        SimpleEQHostSim --benchmark
+
+    Exits with 2 if the audio thread allocated or locked, 1 on a bad trace
+    or a failed check.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmark.h"
+#include "EngineHolder.h"
+#include "GainCheck.h"
+#include "HostTrace.h"
+#include "KernelCheck.h"
+#include "MatchCheck.h"
+#include "SnapshotCheck.h"
+#include "WavefrontCheck.h"
+#include "../PluginProcessor.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+namespace
+{
+    //set around everything a host would call on its audio thread
+    thread_local bool onAudioThread = false;
+
+    std::atomic<int> audioThreadAllocations{ 0 }, audioThreadFrees{ 0 }, audioThreadLocks{ 0 };
+
+    struct AudioThreadScope
+    {
+        AudioThreadScope() { onAudioThread = true; }
+        ~AudioThreadScope() { onAudioThread = false; }
+    };
+
+   #if JUCE_LINUX
+    //malloc and free are interposed below and count new and delete along with everything else
+    constexpr bool countInOperatorNew = false;
+   #else
+    constexpr bool countInOperatorNew = true;
+   #endif
+
+    void* allocate(std::size_t size)
+    {
+        if (countInOperatorNew && onAudioThread)
+            ++audioThreadAllocations;
+
+        if (auto* p = std::malloc(size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        if (countInOperatorNew && onAudioThread)
+            ++audioThreadAllocations;
+
+        auto align = juce::jmax(static_cast<std::size_t>(alignment), sizeof(void*));
+
+       #if JUCE_WINDOWS
+        if (auto* p = _aligned_malloc(size == 0 ? 1 : size, align))
+            return p;
+       #else
+        void* p = nullptr;
+        if (posix_memalign(&p, align, size == 0 ? 1 : size) == 0)
+            return p;
+       #endif
+
+        throw std::bad_alloc();
+    }
+
+    void release(void* p)
+    {
+        if (countInOperatorNew && p != nullptr && onAudioThread)
+            ++audioThreadFrees;
+
+        std::free(p);
+    }
+
+    void releaseAligned(void* p)
+    {
+        if (countInOperatorNew && p != nullptr && onAudioThread)
+            ++audioThreadFrees;
+
+       #if JUCE_WINDOWS
+        _aligned_free(p);
+       #else
+        std::free(p);
+       #endif
+    }
+}
+
+//every allocation in the process goes through here, so the audio thread's can be counted
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+
+#if JUCE_LINUX
+//std::mutex, juce::CriticalSection and juce::WaitableEvent all end up here
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    using LockFunction = int (*)(pthread_mutex_t*);
+    static auto realLock = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+
+    if (onAudioThread)
+        ++audioThreadLocks;
+
+    return realLock(mutex);
+}
+
+namespace
+{
+    //the C allocator the functions below forward to, looked up on first use
+    struct CAllocator
+    {
+        void* (*malloc)(std::size_t);
+        void* (*calloc)(std::size_t, std::size_t);
+        void* (*realloc)(void*, std::size_t);
+        void (*free)(void*);
+        int (*posixMemalign)(void**, std::size_t, std::size_t);
+        void* (*alignedAlloc)(std::size_t, std::size_t);
+    };
+
+    CAllocator realAllocator{};
+    bool findingAllocator = false;
+
+    //dlsym can calloc while it looks; that comes from here and is never given back
+    alignas(std::max_align_t) char bootstrapHeap[4096];
+    std::size_t bootstrapUsed = 0;
+
+    bool isBootstrap(void* p)
+    {
+        return p >= static_cast<void*>(bootstrapHeap) && p < static_cast<void*>(bootstrapHeap + sizeof(bootstrapHeap));
+    }
+
+    void* allocateBootstrap(std::size_t size)
+    {
+        auto aligned = (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+        if (bootstrapUsed + aligned > sizeof(bootstrapHeap))
+            return nullptr;
+
+        auto* p = bootstrapHeap + bootstrapUsed;
+        bootstrapUsed += aligned;
+        return p;
+    }
+
+    template <typename Function>
+    Function findNext(const char* name)
+    {
+        return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+    }
+
+    //nullptr while dlsym is still looking
+    const CAllocator* getRealAllocator()
+    {
+        if (realAllocator.free == nullptr && !findingAllocator)
+        {
+            findingAllocator = true;
+
+            CAllocator found;
+            found.malloc = findNext<decltype(found.malloc)>("malloc");
+            found.calloc = findNext<decltype(found.calloc)>("calloc");
+            found.realloc = findNext<decltype(found.realloc)>("realloc");
+            found.posixMemalign = findNext<decltype(found.posixMemalign)>("posix_memalign");
+            found.alignedAlloc = findNext<decltype(found.alignedAlloc)>("aligned_alloc");
+            found.free = findNext<decltype(found.free)>("free");
+            realAllocator = found;
+
+            findingAllocator = false;
+        }
+
+        return realAllocator.free != nullptr ? &realAllocator : nullptr;
+    }
+}
+
+//juce::HeapBlock, std::vector through new, strdup and whatever a library does all end up here
+extern "C" void* malloc(std::size_t size)
+{
+    if (onAudioThread)
+        ++audioThreadAllocations;
+
+    auto* real = getRealAllocator();
+    return real != nullptr ? real->malloc(size) : allocateBootstrap(size);
+}
+
+extern "C" void* calloc(std::size_t count, std::size_t size)
+{
+    if (onAudioThread)
+        ++audioThreadAllocations;
+
+    //the bootstrap heap is static, so it's already zeroed
+    auto* real = getRealAllocator();
+    return real != nullptr ? real->calloc(count, size) : allocateBootstrap(count * size);
+}
+
+extern "C" void* realloc(void* p, std::size_t size)
+{
+    if (onAudioThread)
+        ++audioThreadAllocations;
+
+    auto* real = getRealAllocator();
+
+    if (real == nullptr || isBootstrap(p))
+    {
+        auto* moved = real != nullptr ? real->malloc(size) : allocateBootstrap(size);
+
+        if (moved != nullptr && p != nullptr)
+            std::memcpy(moved, p, juce::jmin(size, std::size_t(bootstrapHeap + sizeof(bootstrapHeap) - static_cast<char*>(p))));
+
+        return moved;
+    }
+
+    return real->realloc(p, size);
+}
+
+extern "C" void free(void* p)
+{
+    if (p == nullptr || isBootstrap(p))
+        return;
+
+    if (onAudioThread)
+        ++audioThreadFrees;
+
+    if (auto* real = getRealAllocator())
+        real->free(p);
+}
+
+extern "C" int posix_memalign(void** p, std::size_t alignment, std::size_t size)
+{
+    if (onAudioThread)
+        ++audioThreadAllocations;
+
+    auto* real = getRealAllocator();
+    return real != nullptr ? real->posixMemalign(p, alignment, size) : ENOMEM;
+}
+
+extern "C" void* aligned_alloc(std::size_t alignment, std::size_t size)
+{
+    if (onAudioThread)
+        ++audioThreadAllocations;
+
+    auto* real = getRealAllocator();
+    return real != nullptr ? real->alignedAlloc(alignment, size) : nullptr;
+}
+#endif
+
+namespace
+{
+    struct BlockTiming
+    {
+        double microseconds;
+        double budgetMicroseconds; //how long the block lasts at the current sample rate
+        int line;
+    };
+
+    struct RunReport
+    {
+        std::vector<BlockTiming> blocks;
+        double worstPrepareMicroseconds{ 0 }, worstStateMicroseconds{ 0 };
+        juce::Array<int> allocatingLines, lockingLines;
+    };
+
+    double ticksToMicroseconds(juce::int64 ticks)
+    {
+        return double(ticks) * 1.0e6 / double(juce::Time::getHighResolutionTicksPerSecond());
+    }
+
+    juce::Result replay(const std::vector<HostEvent>& events, RunReport& report)
+    {
+        SimpleEQAudioProcessor processor;
+        juce::Random random(0x5eed);
+
+        //room for the largest block in the trace, allocated up front like a host does
+        int maxBlockSize = 0;
+        for (const auto& event : events)
+            maxBlockSize = juce::jmax(maxBlockSize, event.numSamples);
+
+        juce::AudioBuffer<float> buffer(processor.getTotalNumInputChannels(), maxBlockSize);
+        juce::MidiBuffer midi;
+        double sampleRate = 0;
+
+        for (const auto& event : events)
+        {
+            auto allocationsBefore = audioThreadAllocations + audioThreadFrees;
+            auto locksBefore = audioThreadLocks.load();
+
+            switch (event.type)
+            {
+                case HostEvent::Prepare:
+                {
+                    sampleRate = event.sampleRate;
+                    auto start = juce::Time::getHighResolutionTicks();
+
+                    processor.setRateAndBufferSizeDetails(event.sampleRate, event.numSamples);
+                    processor.prepareToPlay(event.sampleRate, event.numSamples);
+
+                    report.worstPrepareMicroseconds = juce::jmax(report.worstPrepareMicroseconds,
+                                                                 ticksToMicroseconds(juce::Time::getHighResolutionTicks() - start));
+                    break;
+                }
+
+                case HostEvent::Block:
+                {
+                    juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), event.numSamples);
+
+                    for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                        for (int i = 0; i < event.numSamples; ++i)
+                            block.setSample(ch, i, (random.nextFloat() * 2.f - 1.f) * 0.25f);
+
+                    juce::int64 start, end;
+                    {
+                        AudioThreadScope audioThread;
+                        start = juce::Time::getHighResolutionTicks();
+                        processor.processBlock(block, midi);
+                        end = juce::Time::getHighResolutionTicks();
+                    }
+
+                    auto elapsed = ticksToMicroseconds(end - start);
+                    report.blocks.push_back({ elapsed, event.numSamples * 1.0e6 / sampleRate, event.line });
+                    break;
+                }
+
+                case HostEvent::Param:
+                {
+                    auto* param = processor.apvts.getParameter(event.parameterID);
+                    if (param == nullptr)
+                        return juce::Result::fail("line " + juce::String(event.line) + ": no parameter " + event.parameterID);
+
+                    //automation arrives on the audio thread, the way the plugin wrappers deliver it
+                    AudioThreadScope audioThread;
+                    auto normalised = param->convertTo0to1(event.value);
+                    param->setValue(normalised);
+                    param->sendValueChangedMessageToListeners(normalised);
+                    break;
+                }
+
+                case HostEvent::State:
+                {
+                    juce::MemoryBlock state;
+
+                    if (event.stateFile.existsAsFile())
+                        event.stateFile.loadFileAsData(state);
+                    else
+                        processor.getStateInformation(state);
+
+                    auto start = juce::Time::getHighResolutionTicks();
+                    processor.setStateInformation(state.getData(), (int) state.getSize());
+
+                    report.worstStateMicroseconds = juce::jmax(report.worstStateMicroseconds,
+                                                               ticksToMicroseconds(juce::Time::getHighResolutionTicks() - start));
+                    break;
+                }
+            }
+
+            if (audioThreadAllocations + audioThreadFrees != allocationsBefore)
+                report.allocatingLines.addIfNotAlreadyThere(event.line);
+            if (audioThreadLocks != locksBefore)
+                report.lockingLines.addIfNotAlreadyThere(event.line);
+        }
+
+        processor.releaseResources();
+        return juce::Result::ok();
+    }
+
+    //everything after prepareToPlay that a host or the processor may call on the audio thread:
+    //every parameter of the processor moved while blocks run (with both snapshots stored, so
+    //the morph runs too), then each EQEngine entry point on its own
+    juce::Result checkAllocations()
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+
+        SimpleEQAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        processor.storeSnapshot(Snapshot_A);
+        processor.storeSnapshot(Snapshot_B);
+
+        juce::AudioBuffer<float> buffer(processor.getTotalNumInputChannels(), blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(0x5eed);
+
+        auto fill = [&random](float* samples, int numSamples) {
+            for (int i = 0; i < numSamples; ++i)
+                samples[i] = (random.nextFloat() * 2.f - 1.f) * 0.25f;
+        };
+
+        ChainSettings settings, other;
+        other.peakFreq = 3000.f;
+        other.peakGainInDecibels = -9.f;
+        other.lowCutSlope = Slope_48;
+        other.peakDynamic = true;
+
+        ChainDesign design;
+        designChain(other, sampleRate, design);
+
+        EngineHolder engine(2, settings, sampleRate, blockSize);
+        std::vector<float> interleaved(2 * blockSize);
+
+        const auto& parameters = processor.getParameters();
+        auto allocationsBefore = audioThreadAllocations + audioThreadFrees;
+        auto locksBefore = audioThreadLocks.load();
+
+        {
+            AudioThreadScope audioThread;
+
+            for (auto value : { 0.7f, 0.2f, 1.f, 0.f })
+                for (auto* param : parameters)
+                {
+                    param->setValue(value);
+                    param->sendValueChangedMessageToListeners(value);
+
+                    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                        fill(buffer.getWritePointer(ch), blockSize);
+                    processor.processBlock(buffer, midi);
+                }
+
+            engine->prepare(sampleRate * 2.0, blockSize, 2);
+
+            for (auto mode : { Stereo_DualMono, Stereo_MidSide, Stereo_Linked })
+            {
+                engine->setStereoMode(mode);
+                engine->setParameters(other, 1);
+                engine->setParameters(settings);
+                engine->setAutoGain(mode != Stereo_Linked, Weighting_Pink);
+                engine->setOutputGain(mode == Stereo_Linked ? 0.f : -3.f);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    fill(buffer.getWritePointer(ch), blockSize);
+                engine->processPlanar(buffer.getArrayOfWritePointers(), 2, blockSize);
+
+                engine->setDesign(design);
+                fill(interleaved.data(), 2 * blockSize);
+                engine->processInterleaved(interleaved.data(), blockSize);
+                engine->reset();
+            }
+        }
+
+        processor.releaseResources();
+
+        auto allocations = audioThreadAllocations + audioThreadFrees - allocationsBefore;
+        auto locks = audioThreadLocks - locksBefore;
+
+        std::cout << "after prepareToPlay: " << allocations << " allocation(s) or free(s), " << locks << " lock(s)\n";
+
+        if (allocations + locks > 0)
+            return juce::Result::fail("the audio thread allocated or locked after prepareToPlay");
+
+        return juce::Result::ok();
+    }
+
+    juce::String describeLines(const juce::Array<int>& lines)
+    {
+        juce::StringArray text;
+        for (int i = 0; i < juce::jmin(lines.size(), 10); ++i)
+            text.add(juce::String(lines[i]));
+
+        return text.joinIntoString(", ") + (lines.size() > 10 ? ", ..." : "");
+    }
+
+    void printReport(RunReport& report, int runs)
+    {
+        auto& blocks = report.blocks;
+        std::sort(blocks.begin(), blocks.end(), [](const BlockTiming& a, const BlockTiming& b) {
+            return a.microseconds < b.microseconds;
+        });
+
+        auto percentile = [&blocks](double p) {
+            return blocks[juce::jmin(blocks.size() - 1, size_t(p / 100.0 * double(blocks.size())))].microseconds;
+        };
+
+        std::cout << blocks.size() << " blocks over " << runs << " run(s)\n";
+
+        if (!blocks.empty())
+        {
+            std::cout << "block latency (us): p50 " << percentile(50) << "  p90 " << percentile(90)
+                      << "  p99 " << percentile(99) << "  p99.9 " << percentile(99.9)
+                      << "  worst " << blocks.back().microseconds << "\n";
+
+            std::cout << "slowest blocks:\n";
+            for (size_t i = 0; i < juce::jmin<size_t>(5, blocks.size()); ++i)
+            {
+                const auto& b = blocks[blocks.size() - 1 - i];
+                std::cout << "  line " << b.line << ": " << b.microseconds << " us, "
+                          << juce::roundToInt(100.0 * b.microseconds / b.budgetMicroseconds) << "% of the block's duration\n";
+            }
+        }
+
+        std::cout << "worst prepareToPlay " << report.worstPrepareMicroseconds << " us, "
+                  << "worst setStateInformation " << report.worstStateMicroseconds << " us\n";
+
+        std::cout << "audio thread: " << audioThreadAllocations.load() << " allocation(s), "
+                  << audioThreadFrees.load() << " free(s)";
+       #if JUCE_LINUX
+        std::cout << ", " << audioThreadLocks.load() << " lock(s)\n";
+       #else
+        std::cout << ", locks aren't tracked on this platform\n";
+       #endif
+
+        if (!report.allocatingLines.isEmpty())
+            std::cout << "  allocating at line(s) " << describeLines(report.allocatingLines) << "\n";
+        if (!report.lockingLines.isEmpty())
+            std::cout << "  locking at line(s) " << describeLines(report.lockingLines) << "\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() < 1)
+    {
+        std::cout << "usage: SimpleEQHostSim <trace> [--runs=N]\n"
+                     "       SimpleEQHostSim --check-wavefront\n"
+                     "       SimpleEQHostSim --check-kernels [--golden=<file.wav>] [--update-golden]\n"
+                     "       SimpleEQHostSim --check-allocations\n"
+                     "       SimpleEQHostSim --check-match-eq\n"
+                     "       SimpleEQHostSim --check-snapshots\n"
+                     "       SimpleEQHostSim --check-gain\n"
+                     "       SimpleEQHostSim --benchmark\n";
+        return 1;
+    }
+
+    //the parameter tree and its timers want a message manager, nothing is dispatched though
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (args.containsOption("--check-wavefront"))
+    {
+        auto check = checkWavefront();
+        std::cout << (check.wasOk() ? juce::String("wavefront matches the lane kernel, linked stereo matches mono") : check.getErrorMessage()) << "\n";
+        return check.wasOk() ? 0 : 1;
+    }
+
+    if (args.containsOption("--check-kernels"))
+    {
+        //without --golden it's the committed file, found from the repository root; a missing one fails
+        auto golden = juce::File::getCurrentWorkingDirectory().getChildFile(args.containsOption("--golden")
+                                                                               ? args.getValueForOption("--golden")
+                                                                               : juce::String("Source/HostSim/KernelGolden.wav"));
+        auto check = checkKernels(golden, args.containsOption("--update-golden"));
+        std::cout << (check.wasOk() ? juce::String("every path within tolerance") : check.getErrorMessage()) << "\n";
+        return check.wasOk() ? 0 : 1;
+    }
+
+    if (args.containsOption("--benchmark"))
+    {
+        runBenchmarks();
+        return 0;
+    }
+
+    if (args.containsOption("--check-allocations"))
+    {
+        auto check = checkAllocations();
+        std::cout << (check.wasOk() ? juce::String("no allocations or locks after prepareToPlay") : check.getErrorMessage()) << "\n";
+        return check.wasOk() ? 0 : 1;
+    }
+
+    if (args.containsOption("--check-match-eq"))
+    {
+        auto check = checkMatchEQ();
+        std::cout << (check.wasOk() ? juce::String("match EQ recovers every setting") : check.getErrorMessage()) << "\n";
+        return check.wasOk() ? 0 : 1;
+    }
+
+    if (args.containsOption("--check-snapshots"))
+    {
+        auto check = checkSnapshots();
+        std::cout << (check.wasOk() ? juce::String("recalled snapshots match the live coefficients") : check.getErrorMessage()) << "\n";
+        return check.wasOk() ? 0 : 1;
+    }
+
+    if (args.containsOption("--check-gain"))
+    {
+        auto check = checkGain();
+        std::cout << (check.wasOk() ? juce::String("auto and output gain within tolerance") : check.getErrorMessage()) << "\n";
+        return check.wasOk() ? 0 : 1;
+    }
+
+    std::vector<HostEvent> events;
+    auto result = loadHostTrace(args[0].resolveAsFile(), events);
+
+    auto runs = args.containsOption("--runs") ? juce::jmax(1, args.getValueForOption("--runs").getIntValue()) : 1;
+
+    RunReport report;
+    for (int run = 0; run < runs && result.wasOk(); ++run)
+        result = replay(events, report);
+
+    if (result.failed())
+    {
+        std::cout << result.getErrorMessage() << "\n";
+        return 1;
+    }
+
+    printReport(report, runs);
+
+    return audioThreadAllocations + audioThreadFrees + audioThreadLocks > 0 ? 2 : 0;
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    MatchCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "MatchCheck.h"
+#include "../MatchEQ.h"
+
+#include <iostream>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int gridPointsPerOctave = 12;
+    constexpr double levelOffsetInDecibels = 3.0;
+
+    constexpr double maxFrequencyError = 0.01, maxQualityError = 0.01;
+    constexpr double maxGainErrorInDecibels = 0.05;
+
+    ChainSettings makeSettings(float lowCutFreq, Slope lowCutSlope, float peakFreq, float peakGain, float peakQuality,
+                               float highCutFreq, Slope highCutSlope)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = lowCutFreq;
+        settings.lowCutSlope = lowCutSlope;
+        settings.peakFreq = peakFreq;
+        settings.peakGainInDecibels = peakGain;
+        settings.peakQuality = peakQuality;
+        settings.highCutFreq = highCutFreq;
+        settings.highCutSlope = highCutSlope;
+        return settings;
+    }
+
+    //cuts alone, peak alone, and both cuts around a narrow peak near one of them
+    std::vector<ChainSettings> getCases()
+    {
+        return {
+            makeSettings(80.f, Slope_24, 2000.f, 6.f, 2.f, 12000.f, Slope_12),
+            makeSettings(20.f, Slope_12, 300.f, -9.f, 0.7f, 20000.f, Slope_12),
+            makeSettings(20.f, Slope_12, 120.f, 4.f, 1.f, 5000.f, Slope_48),
+            makeSettings(200.f, Slope_36, 8000.f, -12.f, 4.f, 16000.f, Slope_24)
+        };
+    }
+
+    //the same 1/12 octave grid the match EQ analyses onto
+    std::vector<double> getGrid()
+    {
+        std::vector<double> frequencies;
+        for (double f = 20.0; f <= 20000.0; f *= std::pow(2.0, 1.0 / gridPointsPerOctave))
+            frequencies.push_back(f);
+
+        return frequencies;
+    }
+
+    std::vector<double> getResponse(const ChainSettings& settings, const std::vector<double>& frequencies)
+    {
+        ChainCoefficients chain;
+        designChain(settings, sampleRate, chain);
+
+        std::vector<double> levels;
+        for (auto f : frequencies)
+            levels.push_back(juce::Decibels::gainToDecibels(chain.getMagnitudeForFrequency(f, sampleRate), -200.0)
+                             + levelOffsetInDecibels);
+
+        return levels;
+    }
+
+    juce::String describe(const ChainSettings& s)
+    {
+        return "low cut " + juce::String(s.lowCutFreq, 1) + " Hz/" + juce::String(12 * (s.lowCutSlope + 1))
+             + ", peak " + juce::String(s.peakFreq, 1) + " Hz " + juce::String(s.peakGainInDecibels, 2)
+             + " dB Q " + juce::String(s.peakQuality, 3)
+             + ", high cut " + juce::String(s.highCutFreq, 1) + " Hz/" + juce::String(12 * (s.highCutSlope + 1));
+    }
+
+    bool isClose(double fitted, double expected, double relativeError)
+    {
+        return std::abs(fitted - expected) <= expected * relativeError;
+    }
+
+    bool matches(const ChainSettings& fitted, const ChainSettings& expected)
+    {
+        return fitted.lowCutSlope == expected.lowCutSlope && fitted.highCutSlope == expected.highCutSlope
+            && isClose(fitted.lowCutFreq, expected.lowCutFreq, maxFrequencyError)
+            && isClose(fitted.highCutFreq, expected.highCutFreq, maxFrequencyError)
+            && isClose(fitted.peakFreq, expected.peakFreq, maxFrequencyError)
+            && isClose(fitted.peakQuality, expected.peakQuality, maxQualityError)
+            && std::abs(fitted.peakGainInDecibels - expected.peakGainInDecibels) <= maxGainErrorInDecibels;
+    }
+}
+
+juce::Result checkMatchEQ()
+{
+    auto frequencies = getGrid();
+
+    //a tilted, bumpy source, so the difference is all the fit gets to see
+    SpectrumAnalysis source;
+    source.frequencies = frequencies;
+    source.sampleRate = sampleRate;
+    for (auto f : frequencies)
+        source.levels.push_back(-20.0 - 3.0 * std::log2(f / 1000.0) + 2.0 * std::sin(f * 0.001));
+
+    for (const auto& expected : getCases())
+    {
+        auto target = getResponse(expected, frequencies);
+
+        double rmsError = 0;
+        auto fitted = fitChainToResponse(frequencies.data(), target.data(), (int) frequencies.size(), sampleRate,
+                                         ChainSettings(), &rmsError);
+
+        std::cout << "expected " << describe(expected) << "\n"
+                  << "fitted   " << describe(fitted) << ", rms error " << rmsError << " dB\n";
+
+        if (! matches(fitted, expected))
+            return juce::Result::fail("the fit didn't recover " + describe(expected));
+
+        auto reference = source;
+        for (size_t i = 0; i < target.size(); ++i)
+            reference.levels[i] += target[i];
+
+        auto matched = fitMatchEQ(reference, source, ChainSettings());
+        if (! matches(matched, expected))
+            return juce::Result::fail("the match EQ didn't recover " + describe(expected) + ", got " + describe(matched));
+    }
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,19 @@
+/*
+  ==============================================================================
+
+    MatchCheck.h
+    Fits the chain to responses made by the chain itself, with a level
+    offset on top, and fails unless the fit gets the settings back: every
+    slope, frequencies and Q within 1 %, gain within 0.05 dB. The same
+    curves go through fitMatchEQ() as a pair of synthetic spectra.
+    Run with SimpleEQHostSim --check-match-eq.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//fails on the first setting the fit doesn't recover
+juce::Result checkMatchEQ();
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    SnapshotCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "SnapshotCheck.h"
+#include "EngineHolder.h"
+#include "../PluginProcessor.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr double sampleRate = 96000.0;
+    constexpr int blockSize = 512;
+
+    ChainSettings getStoredSettings()
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 120.f;
+        settings.lowCutSlope = Slope_36;
+        settings.peakFreq = 2500.f;
+        settings.peakGainInDecibels = 7.5f;
+        settings.peakQuality = 2.f;
+        settings.highCutFreq = 9000.f;
+        settings.highCutSlope = Slope_24;
+        return settings;
+    }
+
+    ChainSettings getOtherSettings()
+    {
+        ChainSettings settings;
+        settings.peakFreq = 400.f;
+        settings.peakGainInDecibels = -6.f;
+        return settings;
+    }
+
+    //bit for bit, active sections only
+    bool isSameChain(const ChainCoefficients& a, const ChainCoefficients& b)
+    {
+        if (a.activeSections != b.activeSections)
+            return false;
+
+        for (int i = 0; i < numChainSections; ++i)
+            if (a.isActive(i) && std::memcmp(&a.sections[i], &b.sections[i], sizeof(BiquadCoefficients)) != 0)
+                return false;
+
+        return true;
+    }
+
+    void processBlocks(SimpleEQAudioProcessor& processor, int numBlocks)
+    {
+        juce::AudioBuffer<float> buffer(processor.getTotalNumInputChannels(), blockSize);
+        juce::MidiBuffer midi;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            buffer.clear();
+            processor.processBlock(buffer, midi);
+        }
+    }
+
+    juce::Result checkRoundTrip()
+    {
+        SimpleEQAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        applyChainSettings(getStoredSettings(), processor.apvts);
+        processBlocks(processor, 1);
+
+        auto live = processor.acquireCoefficientSnapshot();
+        if (live.sampleRate != sampleRate)
+            return juce::Result::fail("the published snapshot isn't at the prepared rate");
+
+        processor.storeSnapshot(Snapshot_A);
+
+        applyChainSettings(getOtherSettings(), processor.apvts);
+        processBlocks(processor, 1);
+
+        if (isSameChain(processor.acquireCoefficientSnapshot().coefficients[0], live.coefficients[0]))
+            return juce::Result::fail("moving the knobs didn't change the coefficients");
+
+        processor.recallSnapshot(Snapshot_A);
+        processBlocks(processor, 1);
+
+        if (! isSameChain(processor.acquireCoefficientSnapshot().coefficients[0], live.coefficients[0]))
+            return juce::Result::fail("recalling A doesn't reproduce the coefficients it was stored from");
+
+        return juce::Result::ok();
+    }
+
+    //no blocks at all: the knobs publish on the message thread, at the prepared rate or else 44.1 kHz,
+    //and the first block after a change puts back what the engine runs
+    juce::Result checkStoppedHost()
+    {
+        for (auto prepared : { false, true })
+        {
+            SimpleEQAudioProcessor processor;
+            if (prepared)
+            {
+                processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor.prepareToPlay(sampleRate, blockSize);
+            }
+
+            auto before = processor.acquireCoefficientSnapshot().version;
+            applyChainSettings(getStoredSettings(), processor.apvts);
+
+            auto stopped = processor.acquireCoefficientSnapshot();
+            auto expectedRate = prepared ? sampleRate : 44100.0;
+
+            ChainCoefficients expected;
+            designChain(getStoredSettings(), expectedRate, expected);
+
+            if (stopped.version == before)
+                return juce::Result::fail("moving the knobs with no blocks running published nothing");
+
+            if (stopped.sampleRate != expectedRate || ! isSameChain(stopped.coefficients[0], expected))
+                return juce::Result::fail("the knobs published with no blocks running aren't the knobs' design");
+
+            if (! prepared)
+                continue;
+
+            processBlocks(processor, 1);
+            auto running = processor.acquireCoefficientSnapshot();
+
+            if (running.version == stopped.version)
+                return juce::Result::fail("the first block didn't republish after the message thread");
+
+            if (! isSameChain(running.coefficients[0], expected))
+                return juce::Result::fail("the engine runs other coefficients than the knobs published");
+        }
+
+        return juce::Result::ok();
+    }
+
+    juce::Result checkEngineDesigns()
+    {
+        EngineHolder live(2, getStoredSettings(), sampleRate, blockSize);
+        EngineHolder recalled(2, getOtherSettings(), sampleRate, blockSize);
+
+        ChainDesign design;
+        designChain(getStoredSettings(), sampleRate, design);
+        recalled->setDesign(design);
+
+        if (! isSameChain(recalled->getCoefficients(0), live->getCoefficients(0)))
+            return juce::Result::fail("a design at the engine's own rate isn't taken as is");
+
+        //carries the other settings' coefficients, so taking it as is would show
+        recalled->setParameters(getOtherSettings());
+        designChain(getStoredSettings(), sampleRate * 0.5, design);
+        design.coefficients = recalled->getCoefficients(0);
+        recalled->setDesign(design);
+
+        if (! isSameChain(recalled->getCoefficients(0), live->getCoefficients(0)))
+            return juce::Result::fail("a design at another rate isn't redesigned");
+
+        return juce::Result::ok();
+    }
+}
+
+juce::Result checkSnapshots()
+{
+    for (auto check : { checkRoundTrip, checkStoppedHost, checkEngineDesigns })
+    {
+        auto result = check();
+        if (result.failed())
+            return result;
+    }
+
+    return juce::Result::ok();
+}
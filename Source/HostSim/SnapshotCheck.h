@@ -0,0 +1,22 @@
+/*
+  ==============================================================================
+
+    SnapshotCheck.h
+    Stores an A/B slot at a rate other than 44.1 kHz, moves the knobs away,
+    recalls it, and fails unless the processor publishes exactly the
+    coefficients it ran before the store. Moves the knobs with no blocks
+    running, prepared and not, and fails unless the processor publishes
+    their design from the message thread and the next block republishes
+    what the engine runs. Then checks the engine takes a
+    design made at its own rate as is, and redesigns one made at another.
+    Run with SimpleEQHostSim --check-snapshots.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//fails on the first coefficient that differs
+juce::Result checkSnapshots();
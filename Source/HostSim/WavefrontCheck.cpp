@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    WavefrontCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "WavefrontCheck.h"
+#include "EngineHolder.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr int blockSizes[] = { 1, 3, 7, 31, 32, 33, 100, 512 };
+    constexpr int maxBlockSize = 512;
+
+    constexpr int numSamples = 8192;
+
+    EngineHolder makeEngine(int numChannels, const ChainSettings& settings, double sampleRate, bool wavefront)
+    {
+        EngineHolder holder(numChannels, settings, sampleRate, maxBlockSize);
+        holder->setWavefrontEnabled(wavefront);
+        return holder;
+    }
+
+    ChainSettings getSettings(Slope lowCutSlope, Slope highCutSlope, bool dynamic)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.highCutFreq = 12000.f;
+        settings.lowCutSlope = lowCutSlope;
+        settings.highCutSlope = highCutSlope;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakDynamic = dynamic;
+        settings.peakThreshold = -30.f;
+        return settings;
+    }
+
+    juce::AudioBuffer<float> makeNoise(int numChannels)
+    {
+        juce::AudioBuffer<float> noise(numChannels, numSamples);
+        juce::Random random(0x5eed);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                noise.setSample(ch, i, (random.nextFloat() * 2.f - 1.f) * 0.5f);
+
+        return noise;
+    }
+
+    //halfway through, the peak moves, so the redesign between blocks is covered too
+    void render(EQEngine& engine, juce::AudioBuffer<float>& buffer, int blockSize, ChainSettings settings)
+    {
+        for (int start = 0; start + blockSize <= buffer.getNumSamples(); start += blockSize)
+        {
+            if (start == buffer.getNumSamples() / 2)
+            {
+                settings.peakFreq = 3000.f;
+                engine.setParameters(settings);
+            }
+
+            float* channels[3];
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                channels[ch] = buffer.getWritePointer(ch, start);
+
+            engine.processPlanar(channels, buffer.getNumChannels(), blockSize);
+        }
+    }
+
+    //the same signal in both channels of a linked stereo engine has to come out exactly as mono does:
+    //each channel's detector starts from the set's envelope, so linking can't change its timing
+    juce::Result checkLinkedChannels()
+    {
+        auto noise = makeNoise(1);
+
+        for (auto dynamic : { false, true })
+            for (auto wavefront : { true, false })
+                for (auto blockSize : blockSizes)
+                {
+                    auto settings = getSettings(Slope_24, Slope_24, dynamic);
+                    auto mono = makeEngine(1, settings, 48000.0, wavefront);
+                    auto stereo = makeEngine(2, settings, 48000.0, wavefront);
+
+                    juce::AudioBuffer<float> a(noise), b(2, numSamples);
+                    b.copyFrom(0, 0, noise, 0, 0, numSamples);
+                    b.copyFrom(1, 0, noise, 0, 0, numSamples);
+
+                    render(*mono, a, blockSize, settings);
+                    render(*stereo, b, blockSize, settings);
+
+                    for (int ch = 0; ch < 2; ++ch)
+                        if (std::memcmp(a.getReadPointer(0), b.getReadPointer(ch), sizeof(float) * size_t(numSamples)) != 0)
+                            return juce::Result::fail("linked stereo differs from mono: channel " + juce::String(ch)
+                                                      + (dynamic ? ", dynamic" : "") + (wavefront ? ", wavefront" : ", lanes")
+                                                      + ", blocks of " + juce::String(blockSize));
+                }
+
+        return juce::Result::ok();
+    }
+}
+
+juce::Result checkWavefront()
+{
+    //one channel is mono, three leave the third alone in the first group
+    for (auto numChannels : { 1, 3 })
+    {
+        auto noise = makeNoise(numChannels);
+
+        for (int low = Slope_12; low <= Slope_48; ++low)
+            for (int high = Slope_12; high <= Slope_48; ++high)
+                for (auto dynamic : { false, true })
+                    for (auto blockSize : blockSizes)
+                    {
+                        auto settings = getSettings(static_cast<Slope>(low), static_cast<Slope>(high), dynamic);
+                        auto wavefront = makeEngine(numChannels, settings, 48000.0, true);
+                        auto lanes = makeEngine(numChannels, settings, 48000.0, false);
+
+                        juce::AudioBuffer<float> a(noise), b(noise);
+                        render(*wavefront, a, blockSize, settings);
+                        render(*lanes, b, blockSize, settings);
+
+                        for (int ch = 0; ch < numChannels; ++ch)
+                            if (std::memcmp(a.getReadPointer(ch), b.getReadPointer(ch), sizeof(float) * size_t(numSamples)) != 0)
+                                return juce::Result::fail("wavefront differs from the lane kernel: " + juce::String(numChannels)
+                                                          + " channel(s), slopes " + juce::String(low) + "/" + juce::String(high)
+                                                          + (dynamic ? ", dynamic" : "") + ", blocks of " + juce::String(blockSize));
+                    }
+    }
+
+    return checkLinkedChannels();
+}
@@ -0,0 +1,20 @@
+/*
+  ==============================================================================
+
+    WavefrontCheck.h
+    Runs a lone channel through the wavefront and through the lane kernel
+    at every slope, static and dynamic, over odd block sizes, and fails
+    unless the two are bit-identical. Then a linked stereo engine fed the
+    same signal on both channels has to come out bit-identical to mono,
+    dynamic peak included. SimpleEQHostSim --benchmark times the two kernels.
+    Run with SimpleEQHostSim --check-wavefront.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//fails on the first sample that differs
+juce::Result checkWavefront();
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    MatchEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "MatchEQ.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+    constexpr int fftOrder = 13;
+    constexpr int fftSize = 1 << fftOrder;
+    constexpr int hopSize = fftSize / 2;
+
+    constexpr double gridMin = 20.0, gridMax = 20000.0;
+    constexpr int gridPointsPerOctave = 12;
+
+    //each worker streams its own share of the frames and sums their power spectra
+    void accumulateFrames(juce::AudioFormatReader& reader, juce::int64 firstFrame, juce::int64 endFrame,
+                          std::vector<double>& powerSum)
+    {
+        juce::dsp::FFT fft(fftOrder);
+        juce::dsp::WindowingFunction<float> window(fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+
+        auto numChannels = (int) reader.numChannels;
+        juce::AudioBuffer<float> input(numChannels, fftSize);
+        std::vector<float> frame(fftSize * 2);
+
+        powerSum.assign(fftSize / 2 + 1, 0.0);
+
+        for (auto f = firstFrame; f < endFrame; ++f)
+        {
+            //only the new hop is read, the overlapping half is shifted down
+            if (f == firstFrame)
+            {
+                reader.read(&input, 0, fftSize, f * hopSize, true, true);
+            }
+            else
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    input.copyFrom(ch, 0, input, ch, hopSize, fftSize - hopSize);
+
+                reader.read(&input, fftSize - hopSize, hopSize, f * hopSize + fftSize - hopSize, true, true);
+            }
+
+            std::fill(frame.begin(), frame.end(), 0.f);
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::addWithMultiply(frame.data(), input.getReadPointer(ch), 1.f / numChannels, fftSize);
+
+            window.multiplyWithWindowingTable(frame.data(), fftSize);
+            fft.performFrequencyOnlyForwardTransform(frame.data());
+
+            for (int bin = 0; bin <= fftSize / 2; ++bin)
+                powerSum[bin] += double(frame[bin]) * frame[bin];
+        }
+    }
+
+    //1/3 octave smoothing onto a log grid, so files at different rates line up
+    void smoothOntoGrid(const std::vector<double>& power, double sampleRate, SpectrumAnalysis& result)
+    {
+        auto binWidth = sampleRate / fftSize;
+        auto numPoints = int(std::log2(gridMax / gridMin) * gridPointsPerOctave) + 1;
+
+        result.frequencies.resize(numPoints);
+        result.levels.resize(numPoints);
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto f = gridMin * std::pow(2.0, double(i) / gridPointsPerOctave);
+            auto lowBin = juce::jlimit(1, fftSize / 2, int(std::floor(f * std::pow(2.0, -1.0 / 6.0) / binWidth)));
+            auto highBin = juce::jlimit(lowBin, fftSize / 2, int(std::ceil(f * std::pow(2.0, 1.0 / 6.0) / binWidth)));
+
+            double sum = 0;
+            for (int bin = lowBin; bin <= highBin; ++bin)
+                sum += power[bin];
+
+            result.frequencies[i] = f;
+            result.levels[i] = 10.0 * std::log10(sum / (highBin - lowBin + 1) + 1.0e-20);
+        }
+    }
+}
+
+juce::Result analyseSpectrum(const juce::File& file, SpectrumAnalysis& result, int numThreads)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    if (numThreads <= 0)
+        numThreads = juce::SystemStats::getNumCpus();
+
+    //one reader per worker, created here because the format manager isn't shared across threads
+    std::vector<std::unique_ptr<juce::AudioFormatReader>> readers;
+    for (int i = 0; i < numThreads; ++i)
+    {
+        readers.emplace_back(formatManager.createReaderFor(file));
+
+        if (readers.back() == nullptr)
+            return juce::Result::fail("Couldn't read " + file.getFullPathName());
+    }
+
+    auto numSamples = readers.front()->lengthInSamples;
+    if (numSamples < fftSize)
+        return juce::Result::fail(file.getFileName() + " is too short to analyse");
+
+    auto numFrames = (numSamples - fftSize) / hopSize + 1;
+    numThreads = (int) juce::jmin<juce::int64>(numThreads, numFrames);
+
+    std::vector<std::vector<double>> partialSums(numThreads);
+
+    juce::ThreadPool pool(numThreads);
+    juce::WaitableEvent finished;
+    std::atomic<int> remaining{ numThreads };
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        auto first = numFrames * i / numThreads;
+        auto end = numFrames * (i + 1) / numThreads;
+
+        pool.addJob([&, i, first, end] {
+            accumulateFrames(*readers[i], first, end, partialSums[i]);
+
+            if (--remaining == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait();
+
+    std::vector<double> power(fftSize / 2 + 1, 0.0);
+    for (const auto& partial : partialSums)
+        for (size_t bin = 0; bin < power.size(); ++bin)
+            power[bin] += partial[bin] / double(numFrames);
+
+    result.sampleRate = readers.front()->sampleRate;
+    result.numFrames = numFrames;
+    smoothOntoGrid(power, result.sampleRate, result);
+
+    return juce::Result::ok();
+}
+
+ChainSettings fitMatchEQ(const SpectrumAnalysis& reference, const SpectrumAnalysis& source, const ChainSettings& current)
+{
+    jassert(reference.frequencies.size() == source.frequencies.size());
+
+    std::vector<double> difference(reference.levels.size());
+    for (size_t i = 0; i < difference.size(); ++i)
+        difference[i] = reference.levels[i] - source.levels[i];
+
+    return fitChainToResponse(reference.frequencies.data(), difference.data(), (int) difference.size(),
+                              reference.sampleRate, current);
+}
+
+juce::Result matchEQ(const juce::File& reference, const juce::File& source,
+                     juce::AudioProcessorValueTreeState& apvts, int numThreads)
+{
+    SpectrumAnalysis referenceSpectrum, sourceSpectrum;
+
+    auto result = analyseSpectrum(reference, referenceSpectrum, numThreads);
+    if (result.wasOk())
+        result = analyseSpectrum(source, sourceSpectrum, numThreads);
+
+    if (result.failed())
+        return result;
+
+    applyChainSettings(fitMatchEQ(referenceSpectrum, sourceSpectrum, getChainSettings(apvts)), apvts);
+
+    return juce::Result::ok();
+}
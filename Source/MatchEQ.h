@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    MatchEQ.h
+    Offline match EQ: averaged (Welch) spectra of a reference and a source
+    file, and a least squares fit of the difference onto the plugin's low
+    cut, peak and high cut. The fit itself is in Core/ResponseFit.h, for
+    callers that already have a curve.
+
+    Files are streamed through an AudioFormatReader per worker thread, so
+    hour long files are never loaded whole. Nothing here needs an editor,
+    so batch jobs can call matchEQ() on a bare SimpleEQAudioProcessor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Core/ResponseFit.h"
+
+struct SpectrumAnalysis
+{
+    std::vector<double> frequencies; //log spaced grid, Hz
+    std::vector<double> levels;      //smoothed power at each grid point, dB
+    double sampleRate{ 0 };
+    juce::int64 numFrames{ 0 };      //number of FFT frames averaged
+};
+
+//numThreads <= 0 uses every core
+juce::Result analyseSpectrum(const juce::File& file, SpectrumAnalysis& result, int numThreads = 0);
+
+//settings that move source towards reference: fitChainToResponse() on the difference of the
+//two spectra. the dynamic peak settings are taken from current
+ChainSettings fitMatchEQ(const SpectrumAnalysis& reference, const SpectrumAnalysis& source, const ChainSettings& current);
+
+//the whole thing: analyse both files, fit, write back through applyChainSettings
+juce::Result matchEQ(const juce::File& reference, const juce::File& source,
+                     juce::AudioProcessorValueTreeState& apvts, int numThreads = 0);
@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "MatchEQ.h"
 
 void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
     const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider& slider)
@@ -16,14 +17,9 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, i
 
     auto bounds = Rectangle<float>(x, y, width, height);
 
-    g.setColour(Colour(97u, 18u, 167u));
-    g.fillEllipse(bounds);
-
-    g.setColour(Colour(255u, 154u, 1u));
-    g.drawEllipse(bounds, 1.f);
-
     Path p;
 
+    //RotarySliderWithLabels already has the body in its cached background
     if (auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider))
     {
         auto center = bounds.getCentre();
@@ -43,6 +39,7 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, i
 
         p.applyTransform(AffineTransform().rotated(sliderAngRad, center.getX(), center.getY()));
 
+        g.setColour(Colour(255u, 154u, 1u));
         g.fillPath(p);
 
         g.setFont(rswl->getTextHeight());
@@ -58,7 +55,22 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, i
         g.setColour(Colours::white);
         g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
     }
+    else
+    {
+        drawRotarySliderBody(g, bounds);
+    }
+
+}
+
+void LookAndFeel::drawRotarySliderBody(juce::Graphics& g, juce::Rectangle<float> bounds)
+{
+    using namespace juce;
+
+    g.setColour(Colour(97u, 18u, 167u));
+    g.fillEllipse(bounds);
 
+    g.setColour(Colour(255u, 154u, 1u));
+    g.drawEllipse(bounds, 1.f);
 }
 
 juce::String RotarySliderWithLabels::getDisplayString() const
@@ -99,22 +111,26 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 }
 
 //==============================================================================
+namespace
+{
+    const float rotaryStartAngle = juce::degreesToRadians(180.f + 45.f);
+    const float rotaryEndAngle = juce::degreesToRadians(180.f - 45.f) + juce::MathConstants<float>::twoPi;
+}
+
 void RotarySliderWithLabels::paint(juce::Graphics& g)
 {
     using namespace juce;
 
-    auto startAng = degreesToRadians(180.f + 45.f);
-    auto endAng = degreesToRadians(180.f - 45.f) + MathConstants<float>::twoPi;
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
 
-    auto range = getRange();
+    if (backgroundLayer.isNull() || scale != backgroundScale)
+        renderBackground(scale);
 
-    auto sliderBounds = getSliderBounds();
+    g.drawImage(backgroundLayer, getLocalBounds().toFloat());
 
-    //g.setColour(Colours::red);
-    //g.drawRect(getLocalBounds());
-    //g.setColour(Colours::green);
-    //g.drawRect(sliderBounds);
+    auto range = getRange();
 
+    auto sliderBounds = getSliderBounds();
 
     getLookAndFeel().drawRotarySlider(g, 
                                     sliderBounds.getX(), 
@@ -122,9 +138,37 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
                                     sliderBounds.getWidth(), 
                                     sliderBounds.getHeight(), 
                                     jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0), 
-                                    startAng, 
-                                    endAng, 
+                                    rotaryStartAngle, 
+                                    rotaryEndAngle, 
                                     *this);
+}
+
+void RotarySliderWithLabels::resized()
+{
+    juce::Slider::resized();
+
+    backgroundLayer = {};
+}
+
+void RotarySliderWithLabels::renderBackground(float scale)
+{
+    using namespace juce;
+
+    backgroundScale = scale;
+
+    auto width = jmax(1, roundToInt(getWidth() * scale));
+    auto height = jmax(1, roundToInt(getHeight() * scale));
+
+    backgroundLayer = Image(Image::RGB, width, height, true);
+
+    Graphics g(backgroundLayer);
+    g.addTransform(AffineTransform::scale(scale));
+
+    g.fillAll(Colours::black);
+
+    auto sliderBounds = getSliderBounds();
+
+    lnf.drawRotarySliderBody(g, sliderBounds.toFloat());
 
     auto center = sliderBounds.toFloat().getCentre();
     auto radius = sliderBounds.toFloat().getWidth() * 0.5f;
@@ -139,7 +183,7 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
         jassert(0.f <= pos);
         jassert(1.f >= pos);
 
-        auto ang = jmap(pos, 0.f, 1.f, startAng, endAng);
+        auto ang = jmap(pos, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
 
         auto c = center.getPointOnCircumference(radius + getTextHeight() * 0.5f + 1, ang);
 
@@ -169,6 +213,48 @@ juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const
 }
 
 
+//==============================================================================
+void MeterReadout::setMode(MeteringMode newMode)
+{
+    mode = newMode;
+
+    if (mode == Metering_Off)
+        stopTimer();
+    else
+        startTimerHz(10);
+
+    repaint();
+}
+
+void MeterReadout::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    g.fillAll(Colours::black);
+
+    if (mode == Metering_Off)
+        return;
+
+    auto format = [](float value) {
+        return std::isfinite(value) ? String(value, 1) : String("-inf");
+    };
+
+    auto describe = [&format](const String& name, const LoudnessReadings& r) {
+        return name + "  M " + format(r.momentary) + "  S " + format(r.shortTerm)
+             + "  I " + format(r.integrated) + " LUFS  TP " + format(r.truePeak) + " dBTP";
+    };
+
+    StringArray lines;
+    if (mode == Metering_Pre || mode == Metering_PreAndPost)
+        lines.add(describe("Pre", audioProcessor.getPreEQLoudness()));
+    if (mode == Metering_Post || mode == Metering_PreAndPost)
+        lines.add(describe("Post", audioProcessor.getPostEQLoudness()));
+
+    g.setColour(Colours::white);
+    g.setFont(12);
+    g.drawFittedText(lines.joinIntoString("    "), getLocalBounds(), Justification::centredLeft, 1);
+}
+
 //==============================================================================
 
 
@@ -181,14 +267,15 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCutSlope"), "dB/Oct"),
     highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCutFreq"), "Hz"),
     highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCutSlope"), "dB/Oct"),
-    peakFreqSliderAttachment(audioProcessor.apvts, "PeakFreq", peakFreqSlider),
-    peakGainSliderAttachment(audioProcessor.apvts, "PeakGain", peakGainSlider),
-    peakQualitySliderAttachment(audioProcessor.apvts, "PeakQuality", peakQualitySlider),
-    lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCutFreq", lowCutFreqSlider),
-    lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCutSlope", lowCutSlopeSlider),
-    highCutFreqSliderAttachment(audioProcessor.apvts, "HighCutFreq", highCutFreqSlider),
-    highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCutSlope", highCutSlopeSlider),
-    responseCurve(p)
+    peakThresholdSlider(*audioProcessor.apvts.getParameter("PeakThreshold"), "dB"),
+    peakRatioSlider(*audioProcessor.apvts.getParameter("PeakRatio"), ":1"),
+    peakAttackSlider(*audioProcessor.apvts.getParameter("PeakAttack"), "ms"),
+    peakReleaseSlider(*audioProcessor.apvts.getParameter("PeakRelease"), "ms"),
+    morphSliderAttachment(audioProcessor.apvts, "Morph", morphSlider),
+    morphEnabledButtonAttachment(audioProcessor.apvts, "MorphEnabled", morphEnabledButton),
+    outputGainSliderAttachment(audioProcessor.apvts, "OutputGain", outputGainSlider),
+    responseCurve(p),
+    meterReadout(p)
 
 {
 
@@ -216,6 +303,18 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     highCutSlopeSlider.labels.add({ 0.f, "-12dB" });
     highCutSlopeSlider.labels.add({ 1.f, "-48dB" });
 
+    peakThresholdSlider.labels.add({ 0.f, "-60dB" });
+    peakThresholdSlider.labels.add({ 1.f, "0dB" });
+
+    peakRatioSlider.labels.add({ 0.f, "1:1" });
+    peakRatioSlider.labels.add({ 1.f, "20:1" });
+
+    peakAttackSlider.labels.add({ 0.f, "0.1ms" });
+    peakAttackSlider.labels.add({ 1.f, "100ms" });
+
+    peakReleaseSlider.labels.add({ 0.f, "5ms" });
+    peakReleaseSlider.labels.add({ 1.f, "1s" });
+
 
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -225,7 +324,54 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
 
     addAndMakeVisible(&responseCurve);
 
-    setSize (600, 500);
+    //the box needs its items before the attachment selects one
+    if (auto* meteringParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Metering")))
+        meteringModeBox.addItemList(meteringParam->choices, 1);
+
+    meteringModeBox.onChange = [this] {
+        meterReadout.setMode(static_cast<MeteringMode>(meteringModeBox.getSelectedItemIndex()));
+    };
+
+    meteringModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "Metering", meteringModeBox);
+    meterReadout.setMode(static_cast<MeteringMode>(meteringModeBox.getSelectedItemIndex()));
+
+    addAndMakeVisible(meteringModeBox);
+    addAndMakeVisible(meterReadout);
+
+    matchEQButton.onClick = [this] { chooseMatchEQFiles(); };
+    addAndMakeVisible(matchEQButton);
+
+    if (auto* autoGainParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("AutoGain")))
+        autoGainBox.addItemList(autoGainParam->choices, 1);
+
+    autoGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "AutoGain", autoGainBox);
+    addAndMakeVisible(autoGainBox);
+
+    outputGainSlider.setTextValueSuffix(" dB");
+
+    storeAButton.onClick = [this] { audioProcessor.storeSnapshot(Snapshot_A); updateSnapshotButtons(); };
+    storeBButton.onClick = [this] { audioProcessor.storeSnapshot(Snapshot_B); updateSnapshotButtons(); };
+    recallAButton.onClick = [this] { audioProcessor.recallSnapshot(Snapshot_A); };
+    recallBButton.onClick = [this] { audioProcessor.recallSnapshot(Snapshot_B); };
+    updateSnapshotButtons();
+
+    editParameterSet(0);
+
+    if (auto* stereoParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("StereoMode")))
+        stereoModeBox.addItemList(stereoParam->choices, 1);
+
+    stereoModeBox.onChange = [this] { updateStereoButtons(); };
+    stereoModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "StereoMode", stereoModeBox);
+    addAndMakeVisible(stereoModeBox);
+
+    for (auto* button : { &editFirstSetButton, &editSecondSetButton })
+        button->setRadioGroupId(1);
+
+    editFirstSetButton.onClick = [this] { editParameterSet(0); };
+    editSecondSetButton.onClick = [this] { editParameterSet(1); };
+    updateStereoButtons();
+
+    setSize (600, 650);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
@@ -236,6 +382,8 @@ SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 //==============================================================================
 void SimpleEQAudioProcessorEditor::paint (juce::Graphics& g)
 {
+    SIMPLEEQ_TRACE_BLOCK("SimpleEQAudioProcessorEditor::paint", audioProcessor.getInstanceId(), 0, 0);
+
     using namespace juce;
 
     // (Our component is opaque, so we must completely fill the background with a solid colour)
@@ -256,6 +404,44 @@ void SimpleEQAudioProcessorEditor::resized()
 
     responseCurve.setBounds(responseArea);
 
+    auto meterArea = bounds.removeFromTop(20);
+    meteringModeBox.setBounds(meterArea.removeFromLeft(100));
+    matchEQButton.setBounds(meterArea.removeFromRight(90));
+    meterReadout.setBounds(meterArea.withTrimmedLeft(5));
+
+    bounds.removeFromTop(5);
+
+    auto gainArea = bounds.removeFromTop(20);
+    autoGainBox.setBounds(gainArea.removeFromLeft(100));
+    outputGainSlider.setBounds(gainArea.removeFromLeft(250).withTrimmedLeft(5));
+
+    bounds.removeFromTop(5);
+
+    auto snapshotArea = bounds.removeFromTop(20);
+    recallAButton.setBounds(snapshotArea.removeFromLeft(30));
+    recallBButton.setBounds(snapshotArea.removeFromLeft(30));
+    storeAButton.setBounds(snapshotArea.removeFromLeft(70).withTrimmedLeft(5));
+    storeBButton.setBounds(snapshotArea.removeFromLeft(70).withTrimmedLeft(5));
+    morphEnabledButton.setBounds(snapshotArea.removeFromLeft(80).withTrimmedLeft(10));
+    editSecondSetButton.setBounds(snapshotArea.removeFromRight(30));
+    editFirstSetButton.setBounds(snapshotArea.removeFromRight(30));
+    stereoModeBox.setBounds(snapshotArea.removeFromRight(100).withTrimmedRight(5));
+    morphSlider.setBounds(snapshotArea);
+
+    bounds.removeFromTop(5);
+
+    juce::Rectangle<int> dynamicsArea = bounds.removeFromBottom(100);
+    juce::Rectangle<int> dynamicsButtonArea = dynamicsArea.removeFromLeft(100);
+
+    peakDynamicButton.setBounds(dynamicsButtonArea.removeFromTop(dynamicsButtonArea.getHeight() * 0.5));
+    peakSidechainButton.setBounds(dynamicsButtonArea);
+
+    auto dynamicsSliderWidth = dynamicsArea.getWidth() / 4;
+    peakThresholdSlider.setBounds(dynamicsArea.removeFromLeft(dynamicsSliderWidth));
+    peakRatioSlider.setBounds(dynamicsArea.removeFromLeft(dynamicsSliderWidth));
+    peakAttackSlider.setBounds(dynamicsArea.removeFromLeft(dynamicsSliderWidth));
+    peakReleaseSlider.setBounds(dynamicsArea);
+
     juce::Rectangle<int> lowCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
     juce::Rectangle<int> lowSlopeArea = lowCutArea.removeFromTop(lowCutArea.getHeight() * 0.5);
     juce::Rectangle<int> highCutArea = bounds.removeFromRight(bounds.getWidth() * 0.5);
@@ -272,8 +458,139 @@ void SimpleEQAudioProcessorEditor::resized()
 
 }
 
+void SimpleEQAudioProcessorEditor::chooseMatchEQFiles()
+{
+    auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+    auto wildcard = juce::String("*.wav;*.aif;*.aiff;*.flac;*.ogg");
+
+    matchEQChooser = std::make_unique<juce::FileChooser>("Choose the reference recording", juce::File(), wildcard);
+    matchEQChooser->launchAsync(flags, [this, flags, wildcard](const juce::FileChooser& chooser) {
+        auto reference = chooser.getResult();
+        if (reference == juce::File())
+            return;
+
+        matchEQChooser = std::make_unique<juce::FileChooser>("Choose the recording to match", reference.getParentDirectory(), wildcard);
+        matchEQChooser->launchAsync(flags, [this, reference](const juce::FileChooser& sourceChooser) {
+            auto source = sourceChooser.getResult();
+            if (source != juce::File())
+                runMatchEQ(reference, source);
+        });
+    });
+}
+
+//analysis and the fit run on their own thread, only the result is written back on the message thread
+void SimpleEQAudioProcessorEditor::runMatchEQ(const juce::File& reference, const juce::File& source)
+{
+    matchEQButton.setEnabled(false);
+    matchEQButton.setButtonText("Analysing...");
+
+    juce::Component::SafePointer<SimpleEQAudioProcessorEditor> safeThis(this);
+    auto current = getChainSettings(audioProcessor.apvts);
+
+    juce::Thread::launch([safeThis, reference, source, current] {
+        SpectrumAnalysis referenceSpectrum, sourceSpectrum;
+
+        auto result = analyseSpectrum(reference, referenceSpectrum);
+        if (result.wasOk())
+            result = analyseSpectrum(source, sourceSpectrum);
+
+        auto fitted = result.wasOk() ? fitMatchEQ(referenceSpectrum, sourceSpectrum, current) : current;
+
+        juce::MessageManager::callAsync([safeThis, result, fitted]() mutable {
+            if (safeThis == nullptr)
+                return;
+
+            auto& apvts = safeThis->audioProcessor.apvts;
+
+            if (result.wasOk())
+            {
+                //the fit leaves the dynamic peak alone; it may have been turned while the files were analysed
+                auto now = getChainSettings(apvts);
+                fitted.peakDynamic = now.peakDynamic;
+                fitted.peakSidechain = now.peakSidechain;
+                fitted.peakThreshold = now.peakThreshold;
+                fitted.peakRatio = now.peakRatio;
+                fitted.peakAttack = now.peakAttack;
+                fitted.peakRelease = now.peakRelease;
+
+                applyChainSettings(fitted, apvts);
+            }
+            else
+            {
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Match EQ", result.getErrorMessage());
+            }
+
+            safeThis->matchEQButton.setEnabled(true);
+            safeThis->matchEQButton.setButtonText("Match EQ...");
+        });
+    });
+}
+
+//a slot can only be recalled once something is stored in it
+void SimpleEQAudioProcessorEditor::updateSnapshotButtons()
+{
+    recallAButton.setEnabled(audioProcessor.hasSnapshot(Snapshot_A));
+    recallBButton.setEnabled(audioProcessor.hasSnapshot(Snapshot_B));
+}
+
+//the knobs and the two switches of the band all move to the other set's parameters
+void SimpleEQAudioProcessorEditor::editParameterSet(int parameterSet)
+{
+    auto& apvts = audioProcessor.apvts;
+    editedSet = parameterSet;
+
+    const std::pair<RotarySliderWithLabels*, BandParameter> sliders[numBandSliders] = {
+        { &lowCutFreqSlider, Band_LowCutFreq }, { &lowCutSlopeSlider, Band_LowCutSlope },
+        { &highCutFreqSlider, Band_HighCutFreq }, { &highCutSlopeSlider, Band_HighCutSlope },
+        { &peakFreqSlider, Band_PeakFreq }, { &peakGainSlider, Band_PeakGain }, { &peakQualitySlider, Band_PeakQuality },
+        { &peakThresholdSlider, Band_PeakThreshold }, { &peakRatioSlider, Band_PeakRatio },
+        { &peakAttackSlider, Band_PeakAttack }, { &peakReleaseSlider, Band_PeakRelease }
+    };
+
+    const std::pair<juce::Button*, BandParameter> buttons[numBandButtons] = {
+        { &peakDynamicButton, Band_PeakDynamic }, { &peakSidechainButton, Band_PeakSidechain }
+    };
+
+    for (int i = 0; i < numBandSliders; ++i)
+    {
+        auto id = getBandParameterID(sliders[i].second, parameterSet);
+
+        bandSliderAttachments[i].reset();
+        sliders[i].first->setParameter(*apvts.getParameter(id));
+        bandSliderAttachments[i] = std::make_unique<sliderAttachment>(apvts, id, *sliders[i].first);
+    }
+
+    for (int i = 0; i < numBandButtons; ++i)
+    {
+        bandButtonAttachments[i].reset();
+        bandButtonAttachments[i] = std::make_unique<buttonAttachment>(apvts, getBandParameterID(buttons[i].second, parameterSet),
+                                                                      *buttons[i].first);
+    }
+
+    editFirstSetButton.setToggleState(parameterSet == 0, juce::dontSendNotification);
+    editSecondSetButton.setToggleState(parameterSet == 1, juce::dontSendNotification);
+}
+
+//linked has only the one set to edit
+void SimpleEQAudioProcessorEditor::updateStereoButtons()
+{
+    auto mode = static_cast<StereoMode>(stereoModeBox.getSelectedItemIndex());
+
+    editFirstSetButton.setButtonText(mode == Stereo_MidSide ? "M" : "L");
+    editSecondSetButton.setButtonText(mode == Stereo_MidSide ? "S" : "R");
+    editSecondSetButton.setEnabled(mode != Stereo_Linked);
+
+    if (mode == Stereo_Linked && editedSet != 0)
+        editParameterSet(0);
+}
+
 std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps() {
-    std::vector<juce::Component*> comps = { &peakFreqSlider, &peakGainSlider, &peakQualitySlider, &lowCutFreqSlider, &highCutFreqSlider, &lowCutSlopeSlider, &highCutSlopeSlider };
+    std::vector<juce::Component*> comps = { &peakFreqSlider, &peakGainSlider, &peakQualitySlider, &lowCutFreqSlider, &highCutFreqSlider, &lowCutSlopeSlider, &highCutSlopeSlider,
+                                            &peakThresholdSlider, &peakRatioSlider, &peakAttackSlider, &peakReleaseSlider,
+                                            &peakDynamicButton, &peakSidechainButton,
+                                            &recallAButton, &recallBButton, &storeAButton, &storeBButton, &morphEnabledButton, &morphSlider,
+                                            &outputGainSlider,
+                                            &editFirstSetButton, &editSecondSetButton };
 
     return comps;
 }
\ No newline at end of file
@@ -16,6 +16,9 @@ struct LookAndFeel : public juce::LookAndFeel_V4
 {
     void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
         const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider& slider) override;
+
+    //the part of the knob that never moves, RotarySliderWithLabels caches it
+    void drawRotarySliderBody(juce::Graphics& g, juce::Rectangle<float> bounds);
 };
 
 struct RotarySliderWithLabels : juce::Slider 
@@ -27,6 +30,7 @@ struct RotarySliderWithLabels : juce::Slider
         suffix(unitSuffix)
     {
         setLookAndFeel(&lnf);
+        setOpaque(true);
     }
 
     ~RotarySliderWithLabels()
@@ -42,7 +46,15 @@ struct RotarySliderWithLabels : juce::Slider
 
     juce::Array<LabelPos> labels;
 
+    //the editor moves the band knobs between parameter sets
+    void setParameter(juce::RangedAudioParameter& rap)
+    {
+        param = &rap;
+        repaint();
+    }
+
     void paint(juce::Graphics& g) override;
+    void resized() override;
     juce::Rectangle<int> getSliderBounds() const;
     int getTextHeight() const { return 14; }
     juce::String getDisplayString() const;
@@ -50,10 +62,31 @@ struct RotarySliderWithLabels : juce::Slider
 private:
     LookAndFeel lnf;
 
+    //background, knob body and range labels; rebuilt only on resize or display scale change
+    juce::Image backgroundLayer;
+    float backgroundScale{ 0.f };
+
+    void renderBackground(float scale);
+
     juce::RangedAudioParameter* param;
     juce::String suffix;
 };
 
+//text readout of the processor's loudness meters, only ticks while metering is on
+struct MeterReadout : juce::Component, juce::Timer
+{
+    MeterReadout(SimpleEQAudioProcessor& p) : audioProcessor(p) {}
+
+    void setMode(MeteringMode newMode);
+
+    void paint(juce::Graphics& g) override;
+    void timerCallback() override { repaint(); }
+
+private:
+    SimpleEQAudioProcessor& audioProcessor;
+    MeteringMode mode{ Metering_Off };
+};
+
 //==============================================================================
 /**
 */
@@ -74,15 +107,56 @@ private:
 
     RotarySliderWithLabels peakFreqSlider, peakGainSlider, peakQualitySlider;
     RotarySliderWithLabels lowCutFreqSlider, highCutFreqSlider, lowCutSlopeSlider, highCutSlopeSlider;
+    RotarySliderWithLabels peakThresholdSlider, peakRatioSlider, peakAttackSlider, peakReleaseSlider;
+
+    juce::ToggleButton peakDynamicButton{ "Dynamic" }, peakSidechainButton{ "Sidechain" };
+
+    juce::TextButton recallAButton{ "A" }, recallBButton{ "B" }, storeAButton{ "Store A" }, storeBButton{ "Store B" };
+    juce::ToggleButton morphEnabledButton{ "Morph" };
+    juce::Slider morphSlider{ juce::Slider::LinearHorizontal, juce::Slider::NoTextBox };
+
+    void updateSnapshotButtons();
 
     std::vector<juce::Component*> getComps();
 
     using sliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
 
-    sliderAttachment peakFreqSliderAttachment, peakGainSliderAttachment, peakQualitySliderAttachment,
-        lowCutFreqSliderAttachment, highCutFreqSliderAttachment, lowCutSlopeSliderAttachment, highCutSlopeSliderAttachment;
+    sliderAttachment morphSliderAttachment;
+
+    using buttonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+
+    buttonAttachment morphEnabledButtonAttachment;
+
+    juce::ComboBox autoGainBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> autoGainAttachment;
+    juce::Slider outputGainSlider{ juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight };
+    sliderAttachment outputGainSliderAttachment;
+
+    //the band controls are attached to one parameter set at a time
+    static constexpr int numBandSliders = 11, numBandButtons = 2;
+    std::unique_ptr<sliderAttachment> bandSliderAttachments[numBandSliders];
+    std::unique_ptr<buttonAttachment> bandButtonAttachments[numBandButtons];
+    int editedSet{ 0 };
+
+    void editParameterSet(int parameterSet);
+
+    juce::ComboBox stereoModeBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> stereoModeAttachment;
+    juce::TextButton editFirstSetButton{ "L" }, editSecondSetButton{ "R" };
+
+    void updateStereoButtons();
 
     ResponseCurveComponent responseCurve;
 
+    juce::TextButton matchEQButton{ "Match EQ..." };
+    std::unique_ptr<juce::FileChooser> matchEQChooser;
+
+    void chooseMatchEQFiles();
+    void runMatchEQ(const juce::File& reference, const juce::File& source);
+
+    juce::ComboBox meteringModeBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> meteringModeAttachment;
+    MeterReadout meterReadout;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessorEditor)
 };
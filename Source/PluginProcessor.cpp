@@ -16,6 +16,7 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -23,10 +24,31 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
     apvts(*this, nullptr, "Parameters", createParameterLayout())
 #endif
 {
+    meteringMode = apvts.getRawParameterValue("Metering");
+    morph = apvts.getRawParameterValue("Morph");
+    morphEnabled = apvts.getRawParameterValue("MorphEnabled");
+    stereoMode = apvts.getRawParameterValue("StereoMode");
+    autoGainMode = apvts.getRawParameterValue("AutoGain");
+    outputGain = apvts.getRawParameterValue("OutputGain");
+
+    apvts.addParameterListener("StereoMode", this);
+    for (int set = 0; set < numParameterSets; ++set)
+        for (int parameter = 0; parameter < numBandParameters; ++parameter)
+            apvts.addParameterListener(getBandParameterID(static_cast<BandParameter>(parameter), set), this);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    apvts.removeParameterListener("StereoMode", this);
+    for (int set = 0; set < numParameterSets; ++set)
+        for (int parameter = 0; parameter < numBandParameters; ++parameter)
+            apvts.removeParameterListener(getBandParameterID(static_cast<BandParameter>(parameter), set), this);
+}
+
+juce::uint32 SimpleEQAudioProcessor::getNextInstanceId()
+{
+    static std::atomic<juce::uint32> nextInstanceId{ 1 };
+    return nextInstanceId++;
 }
 
 //==============================================================================
@@ -94,21 +116,39 @@ void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& n
 //==============================================================================
 void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    SIMPLEEQ_TRACE_BLOCK("prepareToPlay", instanceId, samplesPerBlock, sampleRate);
+
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    juce::dsp::ProcessSpec spec;
+    //the sidechain only feeds the detector, the engine runs the main bus
+    auto numChannels = juce::jmax(getMainBusNumInputChannels(), getMainBusNumOutputChannels(), 1);
+    auto requiredSize = EQEngine::getRequiredMemorySize(numChannels);
 
-    spec.maximumBlockSize = samplesPerBlock;
+    if (engine == nullptr || engine->getMaxChannels() < numChannels) {
+        engine = nullptr;
+        dspMemory.allocate(requiredSize + EQEngine::memoryAlignment, true);
+        dspMemorySize = requiredSize;
+        engine = EQEngine::create(juce::snapPointerToAlignment(dspMemory.get(), EQEngine::memoryAlignment),
+                                  dspMemorySize, numChannels);
+    }
+
+    jassert(engine != nullptr);
 
-    spec.numChannels = 1;
+    engine->setStereoMode(static_cast<StereoMode>(juce::roundToInt(stereoMode->load())));
+    for (int set = 0; set < numParameterSets; ++set)
+        engine->setParameters(getChainSettings(apvts, set), set);
+    updateGain();
+    engine->prepare(sampleRate, samplesPerBlock, numChannels);
+    preparedSampleRate.store(engine->getSampleRate());
 
-    spec.sampleRate = sampleRate;
+    publishCoefficients();
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    preMeter.prepare(sampleRate, numChannels);
+    postMeter.prepare(sampleRate, numChannels);
 
-    updateAllFilter();
+    morphSmoothed.reset(sampleRate, 0.05);
+    morphSmoothed.setCurrentAndTargetValue(morph->load());
 
 }
 
@@ -137,6 +177,13 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain can be off, mono or stereo
+    if (layouts.inputBuses.size() > 1
+     && ! layouts.getChannelSet(true, 1).isDisabled()
+     && layouts.getChannelSet(true, 1) != juce::AudioChannelSet::mono()
+     && layouts.getChannelSet(true, 1) != juce::AudioChannelSet::stereo())
+        return false;
    #endif
 
     return true;
@@ -146,6 +193,8 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    SIMPLEEQ_TRACE_BLOCK("processBlock", instanceId, buffer.getNumSamples(), getSampleRate());
+
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -159,18 +208,37 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateAllFilter();
+    updateAllFilter(buffer.getNumSamples());
+
+    auto mainBuffer = getBusBuffer(buffer, true, 0);
+    auto sidechainBuffer = getBusBuffer(buffer, true, 1);
+    auto numMainChannels = mainBuffer.getNumChannels();
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    auto metering = static_cast<MeteringMode>(meteringMode->load());
+    auto measuresPre = [](MeteringMode mode) { return mode == Metering_Pre || mode == Metering_PreAndPost; };
+    auto measuresPost = [](MeteringMode mode) { return mode == Metering_Post || mode == Metering_PreAndPost; };
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    //a meter switched back on starts over, rather than gating in what it heard before it went off
+    if (measuresPre(metering) && !measuresPre(activeMetering))
+        preMeter.reset();
+    if (measuresPost(metering) && !measuresPost(activeMetering))
+        postMeter.reset();
+    activeMetering = metering;
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    if (measuresPre(metering))
+        preMeter.process(mainBuffer.getArrayOfReadPointers(), numMainChannels, buffer.getNumSamples());
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if (isMorphing()) {
+        if (processMorphed(mainBuffer, sidechainBuffer))
+            publishCoefficients();
+    }
+    else {
+        engine->processPlanar(mainBuffer.getArrayOfWritePointers(), numMainChannels, buffer.getNumSamples(),
+                              sidechainBuffer.getArrayOfReadPointers(), sidechainBuffer.getNumChannels());
+    }
+
+    if (measuresPost(metering))
+        postMeter.process(mainBuffer.getArrayOfReadPointers(), numMainChannels, buffer.getNumSamples());
 
 }
 
@@ -200,12 +268,15 @@ void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    SIMPLEEQ_TRACE_BLOCK("setStateInformation", instanceId, 0, getSampleRate());
+
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    //the next processBlock (or prepareToPlay) redesigns from the new state,
+    //so the audio thread stays the only one writing the engine
     if (tree.isValid()) {
         apvts.replaceState(tree);
-        updateAllFilter();
     }
 }
 
@@ -216,72 +287,271 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
     return new SimpleEQAudioProcessor();
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
+namespace
+{
+    //parameters round trip through normalised floats, so a recalled setting comes back close rather than equal
+    bool settingsMatch(const ChainSettings& a, const ChainSettings& b)
+    {
+        auto near = [](float x, float y) { return std::abs(x - y) <= 1.0e-3f * juce::jmax(1.f, std::abs(x), std::abs(y)); };
+
+        return near(a.peakFreq, b.peakFreq) && near(a.peakGainInDecibels, b.peakGainInDecibels) && near(a.peakQuality, b.peakQuality)
+            && near(a.lowCutFreq, b.lowCutFreq) && near(a.highCutFreq, b.highCutFreq)
+            && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope
+            && a.peakDynamic == b.peakDynamic && a.peakSidechain == b.peakSidechain
+            && near(a.peakThreshold, b.peakThreshold) && near(a.peakRatio, b.peakRatio)
+            && near(a.peakAttack, b.peakAttack) && near(a.peakRelease, b.peakRelease);
+    }
+
+    //literals, so looking one up on the audio thread doesn't build a string
+    const char* const bandParameterIDs[numParameterSets][numBandParameters] = {
+        { "LowCutFreq", "LowCutSlope", "HighCutFreq", "HighCutSlope", "PeakFreq", "PeakGain", "PeakQuality",
+          "PeakDynamic", "PeakSidechain", "PeakThreshold", "PeakRatio", "PeakAttack", "PeakRelease" },
+        { "LowCutFreq2", "LowCutSlope2", "HighCutFreq2", "HighCutSlope2", "PeakFreq2", "PeakGain2", "PeakQuality2",
+          "PeakDynamic2", "PeakSidechain2", "PeakThreshold2", "PeakRatio2", "PeakAttack2", "PeakRelease2" }
+    };
+}
+
+const char* getBandParameterID(BandParameter parameter, int parameterSet)
+{
+    return bandParameterIDs[parameterSet][parameter];
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int parameterSet) {
     ChainSettings settings;
-    
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCutFreq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCutFreq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("PeakFreq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("PeakGain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("PeakQuality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCutSlope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCutSlope")->load());
+
+    auto value = [&apvts, parameterSet](BandParameter parameter) {
+        return apvts.getRawParameterValue(getBandParameterID(parameter, parameterSet))->load();
+    };
+
+    settings.lowCutFreq = value(Band_LowCutFreq);
+    settings.highCutFreq = value(Band_HighCutFreq);
+    settings.peakFreq = value(Band_PeakFreq);
+    settings.peakGainInDecibels = value(Band_PeakGain);
+    settings.peakQuality = value(Band_PeakQuality);
+    settings.lowCutSlope = static_cast<Slope>(value(Band_LowCutSlope));
+    settings.highCutSlope = static_cast<Slope>(value(Band_HighCutSlope));
+
+    settings.peakDynamic = value(Band_PeakDynamic) > 0.5f;
+    settings.peakSidechain = value(Band_PeakSidechain) > 0.5f;
+    settings.peakThreshold = value(Band_PeakThreshold);
+    settings.peakRatio = value(Band_PeakRatio);
+    settings.peakAttack = value(Band_PeakAttack);
+    settings.peakRelease = value(Band_PeakRelease);
 
 
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+void applyChainSettings(const ChainSettings& settings, juce::AudioProcessorValueTreeState& apvts, int parameterSet)
+{
+    auto set = [&apvts, parameterSet](BandParameter parameter, float value) {
+        if (auto* param = apvts.getParameter(getBandParameterID(parameter, parameterSet)))
+        {
+            param->beginChangeGesture();
+            param->setValueNotifyingHost(param->convertTo0to1(value));
+            param->endChangeGesture();
+        }
+    };
+
+    set(Band_LowCutFreq, settings.lowCutFreq);
+    set(Band_LowCutSlope, (float) settings.lowCutSlope);
+    set(Band_HighCutFreq, settings.highCutFreq);
+    set(Band_HighCutSlope, (float) settings.highCutSlope);
+    set(Band_PeakFreq, settings.peakFreq);
+    set(Band_PeakGain, settings.peakGainInDecibels);
+    set(Band_PeakQuality, settings.peakQuality);
+
+    set(Band_PeakDynamic, settings.peakDynamic ? 1.f : 0.f);
+    set(Band_PeakSidechain, settings.peakSidechain ? 1.f : 0.f);
+    set(Band_PeakThreshold, settings.peakThreshold);
+    set(Band_PeakRatio, settings.peakRatio);
+    set(Band_PeakAttack, settings.peakAttack);
+    set(Band_PeakRelease, settings.peakRelease);
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings) {
+void SimpleEQAudioProcessor::storeSnapshot(SnapshotIndex index)
+{
+    //at the rate the engine runs, so recalling is a copy; the audio thread
+    //redesigns by itself if the rate changes afterwards
+    storedSettings[index] = getChainSettings(apvts);
+    auto sampleRate = preparedSampleRate.load();
+
+    ChainDesign design;
+    if (sampleRate > 0)
+        designChain(storedSettings[index], sampleRate, design);
+    else
+        design.settings = storedSettings[index]; //not prepared yet, a rate of 0 never matches
+    snapshotSlots[index].store(design);
+}
 
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+void SimpleEQAudioProcessor::recallSnapshot(SnapshotIndex index)
+{
+    if (!hasSnapshot(index))
+        return;
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    pendingRecall.store(index);
+    applyChainSettings(storedSettings[index], apvts);
+}
 
+bool SimpleEQAudioProcessor::isMorphing() const
+{
+    return morphEnabled->load() > 0.5f && hasSnapshot(Snapshot_A) && hasSnapshot(Snapshot_B);
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements) {
-    *old = *replacements;
+//runs the block in control interval slices, returns true if the coefficients changed
+bool SimpleEQAudioProcessor::processMorphed(juce::AudioBuffer<float>& mainBuffer, juce::AudioBuffer<float>& sidechainBuffer)
+{
+    SIMPLEEQ_TRACE_BLOCK("processMorphed", instanceId, mainBuffer.getNumSamples(), getSampleRate());
+
+    const auto* a = snapshotSlots[Snapshot_A].acquire();
+    const auto* b = snapshotSlots[Snapshot_B].acquire();
+
+    //at either end the stored design is used as is, nothing is designed
+    auto select = [this](const ChainDesign& design) {
+        if (engine->getParameters() == design.settings)
+            return false;
+
+        engine->setDesign(design);
+        return true;
+    };
+
+    morphSmoothed.setTargetValue(morph->load());
+
+    constexpr int maxChannels = 2; //mono or stereo main bus and sidechain, see isBusesLayoutSupported
+    float* channels[maxChannels];
+    const float* sidechain[maxChannels];
+
+    auto numChannels = juce::jmin(mainBuffer.getNumChannels(), maxChannels);
+    auto numSidechainChannels = juce::jmin(sidechainBuffer.getNumChannels(), maxChannels);
+    auto numSamples = mainBuffer.getNumSamples();
+    bool changed = false;
+
+    for (int start = 0; start < numSamples; start += morphControlInterval)
+    {
+        auto length = juce::jmin(morphControlInterval, numSamples - start);
+        auto amount = morphSmoothed.skip(length);
+
+        if (amount <= 0.f)
+            changed |= select(*a);
+        else if (amount >= 1.f)
+            changed |= select(*b);
+        else
+            changed |= engine->setParameters(interpolateSettings(a->settings, b->settings, amount));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[ch] = mainBuffer.getWritePointer(ch, start);
+        for (int ch = 0; ch < numSidechainChannels; ++ch)
+            sidechain[ch] = sidechainBuffer.getReadPointer(ch, start);
+
+        engine->processPlanar(channels, numChannels, length, sidechain, numSidechainChannels);
+    }
+
+    return changed;
 }
 
+void SimpleEQAudioProcessor::updateAllFilter(int numSamples) {
+    SIMPLEEQ_TRACE_BLOCK("updateAllFilter", instanceId, 0, getSampleRate());
 
+    if (engine == nullptr)
+        return;
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings) {
-    
-    //update low cut filter coefficients
-    //auto lowCutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, getSampleRate(), ((chainSettings.lowCutSlope + 1) * 2));
-    auto& lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    auto changed = updateFirstSet(numSamples);
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    //the second set only matters in dual mono and mid/side; linked leaves it alone, so its knobs
+    //moving doesn't republish anything. it goes in before a switch out of linked, which then
+    //designs it once, and after the first set, so one that matches it is copied rather than designed
+    auto mode = static_cast<StereoMode>(juce::roundToInt(stereoMode->load()));
+    if (mode != Stereo_Linked)
+        changed |= engine->setParameters(getChainSettings(apvts, 1), 1);
 
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+    if (mode != engine->getStereoMode()) {
+        engine->setStereoMode(mode);
+        changed = true;
+    }
+
+    //the message thread may have published the knobs in between, the engine has the last word
+    if (changed || republishPending.exchange(false))
+        publishCoefficients();
+
+    updateGain();
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings) {
+//the engine only recomputes the compensation when one of these or the coefficients change
+void SimpleEQAudioProcessor::updateGain()
+{
+    auto mode = static_cast<AutoGainMode>(juce::roundToInt(autoGainMode->load()));
+    engine->setAutoGain(mode != AutoGain_Off, mode == AutoGain_Pink ? Weighting_Pink : Weighting_K);
+    engine->setOutputGain(outputGain->load());
+}
+
+//recall, morph or the knobs; returns true if the coefficients changed
+bool SimpleEQAudioProcessor::updateFirstSet(int numSamples) {
+    auto changed = false;
+
+    //switching to a stored slot is a pointer load and a copy, no design
+    auto recall = pendingRecall.exchange(-1);
+    if (recall >= 0) {
+        if (const auto* design = snapshotSlots[recall].acquire()) {
+            engine->setDesign(*design);
+            recallHoldSamples = int(engine->getSampleRate() * 0.5);
+            changed = true;
+        }
+    }
+
+    //morphing ignores the band parameters, processMorphed sets the engine
+    if (isMorphing())
+        return changed;
+
+    auto settings = getChainSettings(apvts);
 
-    //update high cut filter coefficients
-    //auto& highCutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, getSampleRate(), ((chainSettings.highCutSlope + 1) * 2));
-    auto& highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    //the message thread writes the recalled values one parameter at a time,
+    //don't design the half written mixtures in between
+    if (recallHoldSamples > 0) {
+        if (!settingsMatch(settings, engine->getParameters())) {
+            recallHoldSamples -= numSamples;
+            return changed;
+        }
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get < ChainPositions::HighCut>();
+        recallHoldSamples = 0;
+    }
 
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    return engine->setParameters(settings) || changed;
 }
 
-void SimpleEQAudioProcessor::updateAllFilter() {
-    auto chainSettings = getChainSettings(apvts);
+void SimpleEQAudioProcessor::publishCoefficients()
+{
+    //lost to the message thread publishing at the same time, try again next block
+    if (!coefficientSnapshots.publish(engine->getCoefficients(0), engine->getCoefficients(1), engine->getStereoMode(),
+                                      engine->getSampleRate()))
+        republishPending.store(true);
+}
 
-    updateHighCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateLowCutFilters(chainSettings);
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    //automation on the audio thread is published by the block it comes with. the morph ignores
+    //the knobs, and processMorphed publishes what it runs
+    if (!juce::MessageManager::existsAndIsCurrentThread() || isMorphing())
+        return;
+
+    //never prepared, show it at 44.1 kHz
+    auto sampleRate = preparedSampleRate.load();
+    if (sampleRate <= 0)
+        sampleRate = 44100.0;
+
+    //about twenty biquads, cheaper than anything that hands the job to the audio thread, which
+    //may not be running. linked leaves the second set unused, as the engine does
+    auto mode = static_cast<StereoMode>(juce::roundToInt(stereoMode->load()));
+    ChainCoefficients chains[numParameterSets];
+    designChain(getChainSettings(apvts, 0), sampleRate, chains[0]);
+    if (mode != Stereo_Linked)
+        designChain(getChainSettings(apvts, 1), sampleRate, chains[1]);
+    else
+        chains[1] = chains[0];
+
+    //a running engine may be holding a recall; its next block puts back what it actually runs. lost to a block publishing right now,
+    //that block or the next one has the change anyway
+    coefficientSnapshots.publish(chains[0], chains[1], mode, sampleRate);
+    republishPending.store(true);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout() 
@@ -297,25 +567,68 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
         filterSlopeStrings.add(str);
     }
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCutFreq", 
-                                                            "LowCutFreq", 
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f), 20.f));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCutSlope", "LowCutSlope", filterSlopeStrings, 0));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCutFreq",
-                                                            "HighCutFreq",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f), 20000.f));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCutSlope", "HighCutSlope", filterSlopeStrings, 0));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("PeakFreq",
-                                                            "PeakFreq",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f), 750.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("PeakGain",
-                                                            "PeakGain",
-                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 0.3f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("PeakQuality",
-                                                            "PeakQuality",
-                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 0.3f), 1.f));
+    //the second set goes last, so the first set's parameters keep their old indices
+    auto addBandParameters = [&layout, &filterSlopeStrings](int set)
+    {
+        auto id = [set](BandParameter parameter) { return juce::String(getBandParameterID(parameter, set)); };
+        auto name = [set](BandParameter parameter) { return juce::String(getBandParameterID(parameter, 0)) + (set == 0 ? "" : " R/S"); };
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_LowCutFreq),
+                                                                name(Band_LowCutFreq),
+                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f), 20.f));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id(Band_LowCutSlope), name(Band_LowCutSlope), filterSlopeStrings, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_HighCutFreq),
+                                                                name(Band_HighCutFreq),
+                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f), 20000.f));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id(Band_HighCutSlope), name(Band_HighCutSlope), filterSlopeStrings, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_PeakFreq),
+                                                                name(Band_PeakFreq),
+                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f), 750.f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_PeakGain),
+                                                                name(Band_PeakGain),
+                                                                juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 0.3f), 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_PeakQuality),
+                                                                name(Band_PeakQuality),
+                                                                juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 0.3f), 1.f));
+
+        layout.add(std::make_unique<juce::AudioParameterBool>(id(Band_PeakDynamic), name(Band_PeakDynamic), false));
+        layout.add(std::make_unique<juce::AudioParameterBool>(id(Band_PeakSidechain), name(Band_PeakSidechain), false));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_PeakThreshold),
+                                                                name(Band_PeakThreshold),
+                                                                juce::NormalisableRange<float>(-60.f, 0.f, 0.5f), -24.f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_PeakRatio),
+                                                                name(Band_PeakRatio),
+                                                                juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.4f), 4.f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_PeakAttack),
+                                                                name(Band_PeakAttack),
+                                                                juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.3f), 5.f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id(Band_PeakRelease),
+                                                                name(Band_PeakRelease),
+                                                                juce::NormalisableRange<float>(5.f, 1000.f, 1.f, 0.3f), 100.f));
+    };
+
+    addBandParameters(0);
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Morph",
+                                                            "Morph",
+                                                            juce::NormalisableRange<float>(0.f, 1.f, 0.001f), 0.f));
+    layout.add(std::make_unique<juce::AudioParameterBool>("MorphEnabled", "MorphEnabled", false));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Metering", "Metering",
+                                                            juce::StringArray{ "Off", "Pre", "Post", "Pre + Post" }, Metering_Off));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("AutoGain", "AutoGain",
+                                                            juce::StringArray{ "Off", "Pink", "K-Weighted" }, AutoGain_Off));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("OutputGain",
+                                                            "OutputGain",
+                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.1f), 0.f));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("StereoMode", "StereoMode",
+                                                            juce::StringArray{ "Linked", "Dual Mono", "Mid/Side" }, Stereo_Linked));
+
+    addBandParameters(1);
 
     return layout;
 }
\ No newline at end of file
@@ -9,82 +9,64 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-enum Slope {
-    Slope_12 = 0,
-    Slope_24,
-    Slope_36,
-    Slope_48
+#include "Core/EQEngine.h"
+#include "Core/CoefficientSnapshot.h"
+#include "Core/LoudnessMeter.h"
+#include "Core/SnapshotSlot.h"
+#include "Tracing.h"
+
+//the parameters behind a ChainSettings. there is one of each per parameter set,
+//the second set's IDs are the first's with a "2" on the end
+enum BandParameter {
+    Band_LowCutFreq = 0,
+    Band_LowCutSlope,
+    Band_HighCutFreq,
+    Band_HighCutSlope,
+    Band_PeakFreq,
+    Band_PeakGain,
+    Band_PeakQuality,
+    Band_PeakDynamic,
+    Band_PeakSidechain,
+    Band_PeakThreshold,
+    Band_PeakRatio,
+    Band_PeakAttack,
+    Band_PeakRelease,
+    numBandParameters
 };
 
-struct ChainSettings {
-    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-    float lowCutFreq{ 0 }, highCutFreq{ 0 };
-
-    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-using Filter = juce::dsp::IIR::Filter<float>;
+const char* getBandParameterID(BandParameter parameter, int parameterSet);
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int parameterSet = 0);
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+//writes settings through the parameters so hosts see and record the change; call on the message thread
+void applyChainSettings(const ChainSettings& settings, juce::AudioProcessorValueTreeState& apvts, int parameterSet = 0);
 
-using Coefficients = Filter::CoefficientsPtr;
-
-enum ChainPositions {
-    LowCut,
-    Peak,
-    HighCut
+//choices of the "Metering" parameter
+enum MeteringMode {
+    Metering_Off = 0,
+    Metering_Pre,
+    Metering_Post,
+    Metering_PreAndPost
 };
 
+//choices of the "AutoGain" parameter
+enum AutoGainMode {
+    AutoGain_Off = 0,
+    AutoGain_Pink,
+    AutoGain_KWeighted
+};
 
-
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
-template <int Index, typename ChainType, typename CoeffType>
-void update(ChainType& chain, const CoeffType& coefficients) {
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template <typename ChainType, typename CoeffType>
-void updateCutFilter(ChainType& leftLowCut, const CoeffType& cutCoefficients, const Slope lowCutSlope) {
-
-    leftLowCut.setBypassed<0>(true);
-    leftLowCut.setBypassed<1>(true);
-    leftLowCut.setBypassed<2>(true);
-    leftLowCut.setBypassed<3>(true);
-
-    switch (lowCutSlope) {
-    case Slope_48:
-        update<3>(leftLowCut, cutCoefficients);
-    case Slope_36:
-        update<2>(leftLowCut, cutCoefficients);
-    case Slope_24:
-        update<1>(leftLowCut, cutCoefficients);
-    case Slope_12:
-        update<0>(leftLowCut, cutCoefficients);
-    }
-
-}
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, ((chainSettings.lowCutSlope + 1) * 2));
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, ((chainSettings.highCutSlope + 1) * 2));
-}
+enum SnapshotIndex {
+    Snapshot_A = 0,
+    Snapshot_B,
+    numSnapshots
+};
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     //==============================================================================
@@ -129,17 +111,88 @@ public:
 
 
 
+    //bytes of DSP state per instance: the engine's block (coefficients and filter state for every
+    //channel), the meters, the A/B slots and the published coefficients
+    size_t getDSPMemoryFootprint() const
+    {
+        return dspMemorySize + sizeof(preMeter) + sizeof(postMeter) + sizeof(snapshotSlots) + sizeof(storedSettings)
+             + sizeof(coefficientSnapshots) + sizeof(morphSmoothed);
+    }
+
+    //latest coefficients and sample rate the audio thread is running, or while no blocks come,
+    //the knobs designed on the message thread; lock free. only one reader (the editor), from
+    //the message thread
+    const CoefficientSnapshot& acquireCoefficientSnapshot() { return coefficientSnapshots.acquire(); }
+
+    //loudness before and after the EQ, safe to read from any thread
+    LoudnessReadings getPreEQLoudness() const { return preMeter.getReadings(); }
+    LoudnessReadings getPostEQLoudness() const { return postMeter.getReadings(); }
+
+    //A/B slots, message thread only. storing designs the current parameters ahead of time,
+    //recalling switches the audio thread at its next block and then moves the knobs to match.
+    //slots and the morph cover the first parameter set, the second always follows its knobs
+    void storeSnapshot(SnapshotIndex index);
+    void recallSnapshot(SnapshotIndex index);
+    bool hasSnapshot(SnapshotIndex index) const { return !snapshotSlots[index].isEmpty(); }
+
+    //unique per plugin instance in this process, tags trace events
+    juce::uint32 getInstanceId() const { return instanceId; }
+
 private:
 
-    MonoChain leftChain, rightChain;
+    static juce::uint32 getNextInstanceId();
+    const juce::uint32 instanceId{ getNextInstanceId() };
+
+   #if SIMPLEEQ_ENABLE_TRACING
+    juce::SharedResourcePointer<TraceWriter> traceWriter;
+   #endif
+
+    //one cache line aligned block, sized in prepareToPlay, holding the whole EQEngine
+    juce::HeapBlock<char> dspMemory;
+    size_t dspMemorySize{ 0 };
+    EQEngine* engine{ nullptr };
+
+    CoefficientSnapshotPublisher coefficientSnapshots;
+    std::atomic<bool> republishPending{ false }; //the next block publishes what the engine runs
+
+    //band and stereo mode changes made on the message thread publish straight away, so the
+    //editor follows the knobs while the host is stopped
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    //what prepareToPlay last gave the engine, for designing A/B slots on the message thread
+    std::atomic<double> preparedSampleRate{ 0 };
+
+    //only run when the Metering parameter asks for them
+    LoudnessMeter preMeter, postMeter;
+    std::atomic<float>* meteringMode{ nullptr };
+    MeteringMode activeMetering{ Metering_Off }; //audio thread's, what the last block measured
+
+    //stored designs are read by the audio thread; storedSettings is the message thread's copy
+    SnapshotSlot snapshotSlots[numSnapshots];
+    ChainSettings storedSettings[numSnapshots];
+    std::atomic<int> pendingRecall{ -1 };
+    int recallHoldSamples{ 0 }; //audio thread keeps a recalled design until the parameters catch up
+
+    //"Morph" blends A into B, redesigned once per control interval only while it moves
+    static constexpr int morphControlInterval = 64;
+    std::atomic<float>* morph{ nullptr };
+    std::atomic<float>* morphEnabled{ nullptr };
+    juce::SmoothedValue<float> morphSmoothed;
+
+    bool isMorphing() const;
+    bool processMorphed(juce::AudioBuffer<float>& mainBuffer, juce::AudioBuffer<float>& sidechainBuffer);
 
-    
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    //"StereoMode", a StereoMode
+    std::atomic<float>* stereoMode{ nullptr };
 
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    //"AutoGain", an AutoGainMode, and "OutputGain" in dB; the engine ramps both
+    std::atomic<float>* autoGainMode{ nullptr };
+    std::atomic<float>* outputGain{ nullptr };
 
-    void updateAllFilter();
+    void updateAllFilter(int numSamples);
+    bool updateFirstSet(int numSamples);
+    void updateGain();
+    void publishCoefficients();
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
 };
@@ -12,14 +12,17 @@
 
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : audioProcessor(p)
 {
+    setOpaque(true);
+
     const auto& params = audioProcessor.getParameters();
     for (auto param : params) {
         param->addListener(this);
     }
 
-    updateChain();
+    updateSnapshot();
 
-    startTimer(60);
+    //catch anything published while the editor was being built
+    startFrameUpdates();
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
@@ -28,65 +31,110 @@ ResponseCurveComponent::~ResponseCurveComponent()
     for (auto param : params) {
         param->removeListener(this);
     }
+
+    cancelPendingUpdate();
+    stopFrameUpdates();
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+    SIMPLEEQ_TRACE_BLOCK("ResponseCurveComponent::paint", audioProcessor.getInstanceId(), 0, snapshot.sampleRate);
+
+    using namespace juce;
+
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (backgroundLayer.isNull() || scale != backgroundScale)
+        renderBackground(scale);
+
+    g.drawImage(backgroundLayer, getLocalBounds().toFloat());
+
+    g.setColour(Colours::skyblue);
+    g.strokePath(secondResponseCurve, PathStrokeType(2.f));
+
+    g.setColour(Colours::white);
+    g.strokePath(responseCurve, PathStrokeType(2.f));
+}
+
+void ResponseCurveComponent::resized()
+{
+    backgroundLayer = {};
+
+    responseCurveArea = updateResponseCurve();
+}
+
+void ResponseCurveComponent::renderBackground(float scale)
 {
     using namespace juce;
 
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    backgroundScale = scale;
+
+    backgroundLayer = Image(Image::RGB, jmax(1, roundToInt(getWidth() * scale)), jmax(1, roundToInt(getHeight() * scale)), true);
+
+    Graphics g(backgroundLayer);
+    g.addTransform(AffineTransform::scale(scale));
+
     g.fillAll(Colours::black);
 
     auto responseArea = getLocalBounds();
 
-    auto w = responseArea.getWidth();
+    const float left = responseArea.getX();
+    const float right = responseArea.getRight();
+    const float top = responseArea.getY();
+    const float bottom = responseArea.getBottom();
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+    const float freqs[] = { 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+    const float gains[] = { -24, -12, 0, 12, 24 };
 
-    auto sampleRate = audioProcessor.getSampleRate();
+    g.setFont(10);
 
-    std::vector<double> mags;
+    for (auto f : freqs) {
+        auto x = left + responseArea.getWidth() * mapFromLog10(f, 10.f, 22000.f);
 
-    mags.resize(w);
+        g.setColour(Colours::dimgrey);
+        g.drawVerticalLine(roundToInt(x), top, bottom);
 
-    for (int i = 0; i < w; ++i) {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 10.0, 22000.0);
+        String str;
+        if (f >= 1000.f)
+            str << (f / 1000.f) << "kHz";
+        else
+            str << f << "Hz";
 
-        if (!monoChain.isBypassed<ChainPositions::Peak>()) {
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowcut.isBypassed<0>()) {
-            mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowcut.isBypassed<1>()) {
-            mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowcut.isBypassed<2>()) {
-            mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowcut.isBypassed<3>()) {
-            mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highcut.isBypassed<0>()) {
-            mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highcut.isBypassed<1>()) {
-            mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highcut.isBypassed<2>()) {
-            mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highcut.isBypassed<3>()) {
-            mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+        g.setColour(Colours::lightgrey);
+        g.drawFittedText(str, Rectangle<int>(roundToInt(x) + 2, responseArea.getY() + 2, 40, 10), Justification::left, 1);
+    }
+
+    for (auto gDb : gains) {
+        auto y = jmap(gDb, -24.f, 24.f, bottom, top);
 
-        mags[i] = Decibels::gainToDecibels(mag);
+        g.setColour(gDb == 0.f ? Colour(0u, 172u, 1u) : Colours::darkgrey);
+        g.drawHorizontalLine(roundToInt(y), left, right);
+
+        String str;
+        if (gDb > 0)
+            str << "+";
+        str << gDb << "dB";
+
+        g.setColour(Colours::lightgrey);
+        g.drawFittedText(str, Rectangle<int>(responseArea.getRight() - 42, roundToInt(y) - 5, 40, 10), Justification::right, 1);
     }
 
-    Path responseCurve;
+    g.setColour(Colours::orange);
+    g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f);
+}
+
+juce::Rectangle<int> ResponseCurveComponent::updateResponseCurve()
+{
+    using namespace juce;
+
+    responseCurve.clear();
+    secondResponseCurve.clear();
+
+    auto responseArea = getLocalBounds();
+
+    auto w = responseArea.getWidth();
+    if (w <= 0)
+        return {};
 
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
@@ -94,65 +142,104 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         return jmap(input, -24.0, 24.0, outputMin, outputMax);
     };
 
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    auto numCurves = snapshot.stereoMode == Stereo_Linked ? 1 : numParameterSets;
 
-    for (size_t i = 1; i < mags.size(); ++i) {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
-    }
+    for (int set = 0; set < numCurves; ++set) {
+        auto& path = set == 0 ? responseCurve : secondResponseCurve;
 
-    g.setColour(Colours::orange);
-    g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f);
+        for (int i = 0; i < w; ++i) {
+            auto freq = mapToLog10(double(i) / double(w), 10.0, 22000.0);
+            auto mag = Decibels::gainToDecibels(snapshot.coefficients[set].getMagnitudeForFrequency(freq, snapshot.sampleRate));
 
-    g.setColour(Colours::white);
-    g.strokePath(responseCurve, PathStrokeType(2.f));
-}
+            if (i == 0)
+                path.startNewSubPath(responseArea.getX(), map(mag));
+            else
+                path.lineTo(responseArea.getX() + i, map(mag));
+        }
+    }
 
-void ResponseCurveComponent::resized()
-{
+    auto bounds = responseCurve.getBounds();
+    if (!secondResponseCurve.isEmpty())
+        bounds = bounds.getUnion(secondResponseCurve.getBounds());
 
+    return bounds.expanded(2.f).getSmallestIntegerContainer();
 }
 
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue) {
-    parametersChanged = true;
-    //parametersChanged.set(true);
+    if (!parametersChanged.exchange(true))
+        triggerAsyncUpdate();
 }
 
 void ResponseCurveComponent::parameterGestureChanged(int parameterIndex, bool gestureIsStarting) {
     //we don't care about this boi
 }
 
-void ResponseCurveComponent::timerCallback() 
+void ResponseCurveComponent::handleAsyncUpdate()
 {
-    if (parametersChanged.compareAndSetBool(false, true)) {
-        updateChain();
-        //update the monochain from apvts
-        /*double sampleRate = audioProcessor.getSampleRate();
-
-        auto chainSettings = getChainSettings(audioProcessor.apvts);
-        auto peakCoefficients = makePeakFilter(chainSettings, sampleRate);
-        updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-
-        auto lowCutCoefficients = makeLowCutFilter(chainSettings, sampleRate);
-        auto highCutCoefficients = makeHighCutFilter(chainSettings, sampleRate);
-
-        updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-        updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);*/
-        //signal a repaint to update response curve
-        repaint();
+    startFrameUpdates();
+}
+
+void ResponseCurveComponent::timerCallback()
+{
+    frameCallback();
+}
+
+void ResponseCurveComponent::startFrameUpdates()
+{
+    idleFrames = 0;
+
+#if JUCE_MAJOR_VERSION >= 7
+    if (vBlankAttachment == nullptr)
+        vBlankAttachment = std::make_unique<juce::VBlankAttachment>(this, [this] { frameCallback(); });
+    stopTimer();
+#else
+    startTimerHz(frameHz);
+#endif
+}
+
+void ResponseCurveComponent::stopFrameUpdates()
+{
+#if JUCE_MAJOR_VERSION >= 7
+    vBlankAttachment.reset();
+#else
+    stopTimer();
+#endif
+}
+
+void ResponseCurveComponent::frameCallback()
+{
+    SIMPLEEQ_TRACE_BLOCK("ResponseCurveComponent::frameCallback", audioProcessor.getInstanceId(), 0, snapshot.sampleRate);
+
+    //a running processor publishes on its next block, so keep looking for a few frames after a change
+    constexpr int maxIdleFrames = 10;
+
+    if (parametersChanged.exchange(false))
+        idleFrames = 0;
+
+    if (updateSnapshot()) {
+        idleFrames = 0;
+        repaintResponseCurve();
+    }
+    else if (++idleFrames > maxIdleFrames) {
+        stopFrameUpdates();
     }
 }
 
-void ResponseCurveComponent::updateChain()
+//only repaints where the old and the new curve are
+void ResponseCurveComponent::repaintResponseCurve()
 {
-    double sampleRate = audioProcessor.getSampleRate();
+    auto newArea = updateResponseCurve();
+    repaint(responseCurveArea.getUnion(newArea));
+    responseCurveArea = newArea;
+}
 
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
-    auto peakCoefficients = makePeakFilter(chainSettings, sampleRate);
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+bool ResponseCurveComponent::updateSnapshot()
+{
+    const auto& latest = audioProcessor.acquireCoefficientSnapshot();
 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, sampleRate);
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, sampleRate);
+    if (latest.version == snapshot.version)
+        return false;
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
-}
\ No newline at end of file
+    snapshot = latest;
+    return true;
+}
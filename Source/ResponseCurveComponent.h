@@ -13,7 +13,7 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
-class ResponseCurveComponent : public juce::Component, juce::AudioProcessorParameter::Listener, juce::Timer
+class ResponseCurveComponent : public juce::Component, juce::AudioProcessorParameter::Listener, juce::AsyncUpdater, juce::Timer
 {
 public:
     ResponseCurveComponent(SimpleEQAudioProcessor&);
@@ -22,19 +22,54 @@ public:
     void paint(juce::Graphics&) override;
     void resized() override;
 
+    //can come from the audio thread: sets a flag, and only when it wasn't set already posts
+    //the message that starts frame updates, so a burst of changes wakes the editor once
     void parameterValueChanged(int parameterIndex, float newValue) override;
 
     void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
 
+    void handleAsyncUpdate() override;
+
+    //runs frame updates before JUCE 7
     void timerCallback() override;
 
 private:
 
-    juce::Atomic<bool> parametersChanged{ false };
+    std::atomic<bool> parametersChanged{ false };
+
+    //frames in a row without a new snapshot, frame updates stop after a few
+    int idleFrames{ 0 };
+
+#if JUCE_MAJOR_VERSION >= 7
+    std::unique_ptr<juce::VBlankAttachment> vBlankAttachment;
+#endif
+
+    static constexpr int frameHz = 60;
+
+    //nothing runs between them: the editor sleeps until a parameter changes
+    void startFrameUpdates();
+    void stopFrameUpdates();
+    void frameCallback();
+
+    //copy of the processor's published coefficients, only redrawn when its version moves on.
+    //the editor never designs: a stopped host's processor publishes the knobs itself
+    CoefficientSnapshot snapshot;
+
+    bool updateSnapshot();
+
+    //grid, frequency/dB markings and border; rebuilt only on resize or display scale change
+    juce::Image backgroundLayer;
+    float backgroundScale{ 0.f };
+
+    void renderBackground(float scale);
 
-    MonoChain monoChain;
+    //the second set's curve only exists in dual mono and mid/side
+    juce::Path responseCurve, secondResponseCurve;
+    juce::Rectangle<int> responseCurveArea;
 
-    void updateChain();
+    //rebuilds the paths from the snapshot, returns the area they cover
+    juce::Rectangle<int> updateResponseCurve();
+    void repaintResponseCurve();
 
     SimpleEQAudioProcessor& audioProcessor;
 };
\ No newline at end of file
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    Tracing.cpp
+
+  ==============================================================================
+*/
+
+#include "Tracing.h"
+
+#if SIMPLEEQ_ENABLE_TRACING
+
+namespace
+{
+    //single producer (the owning thread), single consumer (the TraceWriter)
+    struct ThreadBuffer
+    {
+        static constexpr juce::uint32 capacity = 8192;
+
+        TraceEvent events[capacity];
+        std::atomic<juce::uint32> writeIndex{ 0 }, readIndex{ 0 };
+        std::atomic<juce::uint32> dropped{ 0 }; //since the start, never reset
+        juce::uint32 reportedDropped{ 0 };       //the writer's, how many the trace already shows
+    };
+
+    //threads are never handed back, a session with more threads than this loses the extra ones
+    //(the trace counts them as "untraced threads")
+    constexpr int maxThreads = 32;
+
+    ThreadBuffer threadBuffers[maxThreads];
+    std::atomic<int> numThreadBuffers{ 0 };
+
+    thread_local ThreadBuffer* threadBuffer = nullptr;
+    thread_local bool threadBufferClaimed = false;
+
+    ThreadBuffer* getThreadBuffer()
+    {
+        if (!threadBufferClaimed)
+        {
+            threadBufferClaimed = true;
+
+            auto index = numThreadBuffers.fetch_add(1);
+            if (index < maxThreads)
+                threadBuffer = &threadBuffers[index];
+        }
+
+        return threadBuffer;
+    }
+
+    void record(const TraceEvent& event)
+    {
+        auto* buffer = getThreadBuffer();
+        if (buffer == nullptr)
+            return;
+
+        auto write = buffer->writeIndex.load(std::memory_order_relaxed);
+
+        if (write - buffer->readIndex.load(std::memory_order_acquire) >= ThreadBuffer::capacity)
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer->events[write % ThreadBuffer::capacity] = event;
+        buffer->writeIndex.store(write + 1, std::memory_order_release);
+    }
+
+    juce::File getTraceFile()
+    {
+        auto path = juce::SystemStats::getEnvironmentVariable("SIMPLEEQ_TRACE_FILE", {});
+
+        if (path.isNotEmpty())
+            return juce::File(path);
+
+        return juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getChildFile("SimpleEQTrace_" + juce::String(juce::Time::currentTimeMillis()) + ".json");
+    }
+}
+
+//==============================================================================
+TraceScope::TraceScope(const char* name, juce::uint32 instanceId, int blockSize, double sampleRate)
+    : event{ name, juce::Time::getHighResolutionTicks(), 0, instanceId, blockSize, sampleRate }
+{
+}
+
+TraceScope::~TraceScope()
+{
+    event.endTicks = juce::Time::getHighResolutionTicks();
+    record(event);
+}
+
+//==============================================================================
+TraceWriter::TraceWriter()
+    : juce::Thread("SimpleEQ trace writer"),
+      originTicks(juce::Time::getHighResolutionTicks())
+{
+    auto file = getTraceFile();
+    file.deleteFile();
+
+    stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (stream->openedOk())
+    {
+        *stream << "{\"traceEvents\":[\n";
+        startThread();
+    }
+    else
+    {
+        stream.reset();
+    }
+}
+
+TraceWriter::~TraceWriter()
+{
+    stopThread(1000);
+
+    if (stream != nullptr)
+    {
+        drain();
+        *stream << "\n]}\n";
+        stream->flush();
+    }
+}
+
+void TraceWriter::run()
+{
+    while (!threadShouldExit())
+    {
+        drain();
+        wait(100);
+    }
+}
+
+void TraceWriter::write(const juce::String& json)
+{
+    *stream << (firstEvent ? "" : ",\n") << json;
+    firstEvent = false;
+}
+
+//losses show up in the trace itself, as counter tracks next to the events
+void TraceWriter::writeCounter(const char* name, int tid, juce::uint32 value, double timestamp)
+{
+    juce::String json;
+    json << "{\"name\":\"" << name << "\",\"ph\":\"C\",\"pid\":1,\"tid\":" << tid
+         << ",\"ts\":" << juce::String(timestamp, 3)
+         << ",\"args\":{\"count\":" << (int) value << "}}";
+
+    write(json);
+}
+
+void TraceWriter::drain()
+{
+    auto ticksToMicroseconds = 1.0e6 / double(juce::Time::getHighResolutionTicksPerSecond());
+    auto now = double(juce::Time::getHighResolutionTicks() - originTicks) * ticksToMicroseconds;
+    auto numClaimed = numThreadBuffers.load();
+    auto numBuffers = juce::jmin(numClaimed, maxThreads);
+
+    for (int tid = 0; tid < numBuffers; ++tid)
+    {
+        auto& buffer = threadBuffers[tid];
+        auto read = buffer.readIndex.load(std::memory_order_relaxed);
+        auto write = buffer.writeIndex.load(std::memory_order_acquire);
+
+        for (; read != write; ++read)
+        {
+            const auto& e = buffer.events[read % ThreadBuffer::capacity];
+
+            juce::String json;
+            json << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                 << ",\"ts\":" << juce::String(double(e.startTicks - originTicks) * ticksToMicroseconds, 3)
+                 << ",\"dur\":" << juce::String(double(e.endTicks - e.startTicks) * ticksToMicroseconds, 3)
+                 << ",\"args\":{\"instance\":" << (int) e.instanceId
+                 << ",\"blockSize\":" << e.blockSize
+                 << ",\"sampleRate\":" << e.sampleRate << "}}";
+
+            write(json);
+        }
+
+        buffer.readIndex.store(read, std::memory_order_release);
+
+        auto dropped = buffer.dropped.load(std::memory_order_relaxed);
+        if (dropped != buffer.reportedDropped)
+        {
+            writeCounter("dropped events", tid, dropped, now);
+            buffer.reportedDropped = dropped;
+        }
+    }
+
+    auto untraced = juce::uint32(juce::jmax(0, numClaimed - maxThreads));
+    if (untraced != reportedUntracedThreads)
+    {
+        writeCounter("untraced threads", 0, untraced, now);
+        reportedUntracedThreads = untraced;
+    }
+
+    stream->flush();
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    Tracing.h
+    Optional trace scopes for the hot paths, dumped as Chrome trace-event JSON
+    (loads in chrome://tracing and ui.perfetto.dev).
+
+    Off unless the project is built with SIMPLEEQ_ENABLE_TRACING=1, in which
+    case the macros compile to nothing. The output file is taken from the
+    SIMPLEEQ_TRACE_FILE environment variable, or goes to the temp directory.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SIMPLEEQ_ENABLE_TRACING
+ #define SIMPLEEQ_ENABLE_TRACING 0
+#endif
+
+#if SIMPLEEQ_ENABLE_TRACING
+
+struct TraceEvent
+{
+    const char* name; //must be a string literal, only the pointer is stored
+    juce::int64 startTicks, endTicks;
+    juce::uint32 instanceId;
+    int blockSize;
+    double sampleRate;
+};
+
+//times its own lifetime and records it into the calling thread's buffer, no locks or allocation
+class TraceScope
+{
+public:
+    TraceScope(const char* name, juce::uint32 instanceId = 0, int blockSize = 0, double sampleRate = 0);
+    ~TraceScope();
+
+private:
+    TraceEvent event;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceScope)
+};
+
+//drains every thread's buffer to the trace file in the background.
+//shared between plugin instances through a juce::SharedResourcePointer
+class TraceWriter : private juce::Thread
+{
+public:
+    TraceWriter();
+    ~TraceWriter() override;
+
+private:
+    void run() override;
+    void drain();
+    void write(const juce::String& json);
+    void writeCounter(const char* name, int tid, juce::uint32 value, double timestamp);
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::int64 originTicks;
+    bool firstEvent{ true };
+    juce::uint32 reportedUntracedThreads{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceWriter)
+};
+
+ #define SIMPLEEQ_TRACE_SCOPE(name) TraceScope JUCE_JOIN_MACRO(traceScope_, __LINE__) (name)
+ #define SIMPLEEQ_TRACE_BLOCK(name, instanceId, blockSize, sampleRate) \
+    TraceScope JUCE_JOIN_MACRO(traceScope_, __LINE__) (name, instanceId, blockSize, sampleRate)
+
+#else
+
+ #define SIMPLEEQ_TRACE_SCOPE(name)
+ #define SIMPLEEQ_TRACE_BLOCK(name, instanceId, blockSize, sampleRate)
+
+#endif